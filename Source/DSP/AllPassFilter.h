@@ -5,14 +5,19 @@
     
     オールパスフィルターは全ての周波数を同じゲインで通過させるが、
     位相を変化させる。これによりリバーブの密度を高める。
+    SampleType は float / double（遅延線・演算の型）。
+    遅延線の長さは2の累乗で、読み書き位置の折り返しはマスク。
+    単体で使うときは自分のバッファを持ち、DomeReverb の中では DelaySlab から切り出す。
   ==============================================================================
 */
 
 #pragma once
+#include "DelaySlab.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
 
+template <typename SampleType>
 class AllPassFilter
 {
 public:
@@ -23,8 +28,23 @@ public:
     void prepare(double newSampleRate, float maxDelayMs = 100.0f)
     {
         sampleRate = newSampleRate;
-        int maxDelaySamples = static_cast<int>(maxDelayMs * sampleRate / 1000.0);
-        buffer.resize(maxDelaySamples, 0.0f);
+        const int maxDelaySamples = static_cast<int>(maxDelayMs * sampleRate / 1000.0);
+        ownBuffer.assign(static_cast<size_t>(DelaySlab<SampleType>::powerOfTwoLength(maxDelaySamples + 1)),
+                         SampleType(0));   // 再 prepare 時に古いテールを残さない
+        buffer = ownBuffer.data();
+        mask = static_cast<int>(ownBuffer.size()) - 1;
+        writeIndex = 0;
+    }
+
+    // 遅延時間 maxDelayMs までの遅延線を slab から切り出して初期化（slab.layout() の中から呼ぶ）
+    void prepare(double newSampleRate, float maxDelayMs, DelaySlab<SampleType>& slab)
+    {
+        sampleRate = newSampleRate;
+        const int maxDelaySamples = std::max(1, static_cast<int>(maxDelayMs * sampleRate / 1000.0));
+        const int size = DelaySlab<SampleType>::powerOfTwoLength(maxDelaySamples + 1);
+        std::vector<SampleType>().swap(ownBuffer);
+        buffer = slab.allocate(size);
+        mask = size - 1;
         writeIndex = 0;
     }
 
@@ -32,8 +52,8 @@ public:
     void setDelayTime(float delayMs)
     {
         delaySamples = static_cast<int>(delayMs * sampleRate / 1000.0);
-        if (delaySamples >= buffer.size())
-            delaySamples = static_cast<int>(buffer.size()) - 1;
+        if (delaySamples > mask)
+            delaySamples = mask;
         if (delaySamples < 1)
             delaySamples = 1;
     }
@@ -41,43 +61,74 @@ public:
     // フィードバック係数を設定（通常0.5程度）
     void setCoefficient(float coeff)
     {
-        coefficient = std::clamp(coeff, 0.0f, 0.9f);
+        coefficient = static_cast<SampleType>(std::clamp(coeff, 0.0f, 0.9f));
     }
 
     // 1サンプル処理
-    float process(float input)
+    SampleType process(SampleType input)
     {
         // 読み取り位置を計算
-        int readIndex = writeIndex - delaySamples;
-        if (readIndex < 0)
-            readIndex += static_cast<int>(buffer.size());
+        const int readIndex = (writeIndex - delaySamples) & mask;
 
         // 遅延信号を取得
-        float delayed = buffer[readIndex];
+        SampleType delayed = buffer[readIndex];
 
         // オールパスフィルターの計算
         // y[n] = -g * x[n] + x[n-d] + g * y[n-d]
-        float output = -coefficient * input + delayed;
+        SampleType output = -coefficient * input + delayed;
         buffer[writeIndex] = input + coefficient * delayed;
 
         // 書き込み位置を進める
-        writeIndex++;
-        if (writeIndex >= buffer.size())
-            writeIndex = 0;
+        writeIndex = (writeIndex + 1) & mask;
 
         return output;
     }
 
-    // バッファをクリア
+    // ブロック処理（in と out は同じポインタでもよい）
+    // 読み書き位置がどちらも折り返さない連続区間ごとにまとめて処理する
+    void processBlock(const SampleType* input, SampleType* output, int numSamples)
+    {
+        const int size = mask + 1;
+        SampleType* data = buffer;
+
+        int readIndex = (writeIndex - delaySamples) & mask;
+
+        while (numSamples > 0)
+        {
+            const int span = std::min({ numSamples, size - readIndex, size - writeIndex });
+            const SampleType* readPtr = data + readIndex;
+            SampleType* writePtr = data + writeIndex;
+
+            for (int i = 0; i < span; ++i)
+            {
+                const SampleType in = input[i];
+                const SampleType delayed = readPtr[i];
+                writePtr[i] = in + coefficient * delayed;
+                output[i] = -coefficient * in + delayed;
+            }
+
+            input += span;
+            output += span;
+            numSamples -= span;
+
+            readIndex = (readIndex + span) & mask;
+            writeIndex = (writeIndex + span) & mask;
+        }
+    }
+
+    // バッファをクリア（prepare() 前は何もしない）
     void clear()
     {
-        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        if (buffer != nullptr)
+            std::fill(buffer, buffer + mask + 1, SampleType(0));
     }
 
 private:
-    std::vector<float> buffer;
+    SampleType* buffer = nullptr;        // ownBuffer か DelaySlab の中
+    std::vector<SampleType> ownBuffer;   // 単体で使うときだけ
+    int mask = 0;                        // 長さ - 1（長さは2の累乗）
     double sampleRate = 44100.0;
     int writeIndex = 0;
     int delaySamples = 1;
-    float coefficient = 0.5f;
+    SampleType coefficient = SampleType(0.5);
 };
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    ClassicTank.cpp
+    Classic エンジンの後期残響タンクの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "ClassicTank.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
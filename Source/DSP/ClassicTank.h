@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+    ClassicTank.h
+    Classic エンジンの後期残響タンク（並列コム → ペア内クロスフィード → 直列オールパス）
+
+    コムの本数 NumCombs とオールパスの段数 NumAllPasses（どちらもレーンあたり）を
+    コンパイル時に決めた品質ごとのカーネル。本数ごとにループが展開され、
+    使わない本数ぶんの分岐や空のレーンは持たない。
+      Eco      4 / 2   ノート PC の FOH など、負荷を抑えたいとき
+      Standard 8 / 4   従来の音（デフォルト）
+      High    16 / 6   書き出し用の高密度
+    Standard の遅延時間は従来どおり。Eco はその1本おき、High は間に素数寄りの値を足したもの。
+    遅延線は DomeReverb の DelaySlab から、それぞれの遅延に合わせた長さで切り出す。
+    本数が変わっても wet の音量がほぼ揃うよう、出力のゲインで補正する
+    （コムの和は低域でほぼ同相なので 1 / NumCombs、AllPassFilter は係数 0.5 で低域が 1.5 倍になるので
+    Standard の 4 段との差の分）。Standard は従来どおり 1/8。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "CombBank.h"
+#include "AllPassFilter.h"
+#include "StageProfiler.h"
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+// 品質（Classic エンジンのコム・オールパスの本数）
+enum class ReverbQuality
+{
+    Eco,       // コム 4 / オールパス 2
+    Standard,  // コム 8 / オールパス 4
+    High       // コム 16 / オールパス 6
+};
+
+template <typename SampleType, int NumCombs, int NumAllPasses>
+class ClassicTank
+{
+public:
+    static constexpr int combsPerChannel = NumCombs;
+    static constexpr int allPassesPerChannel = NumAllPasses;
+    static constexpr int maxLanes = CombBank<SampleType, NumCombs>::maxChannels;
+
+    // laneDelayScale はレーンごとの遅延時間の倍率（ペアごとの無相関化）
+    // 遅延線は slab から切り出す（slab.layout() の中から呼ぶ）
+    void prepare(double sampleRate, int newNumLanes, const float* laneDelayScale, DelaySlab<SampleType>& slab)
+    {
+        numLanes = std::clamp(newNumLanes, 1, maxLanes);
+
+        float combDelays[CombBank<SampleType, NumCombs>::maxLanes];
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const float* table = combDelaysMs(lane % 2 != 0);
+            for (int c = 0; c < NumCombs; ++c)
+                combDelays[lane * NumCombs + c] = table[c] * laneDelayScale[lane];
+        }
+        longestCombDelayMs = *std::max_element(combDelays, combDelays + numLanes * NumCombs);
+
+        combBank.prepare(sampleRate, combDelays, numLanes, slab);
+        combBank.setFeedback(0.82f);
+        combBank.setDamping(0.3f);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const float* table = allPassDelaysMs(lane % 2 != 0);
+            for (int i = 0; i < NumAllPasses; ++i)
+            {
+                const float delayMs = table[i] * laneDelayScale[lane];
+                allPassFilters[lane][i].prepare(sampleRate, delayMs, slab);
+                allPassFilters[lane][i].setDelayTime(delayMs);
+                allPassFilters[lane][i].setCoefficient(0.5f);
+            }
+        }
+
+        // オールパス1段の DC ゲイン (1 - g + g^2) / (1 - g)（g = 0.5 で 1.5）
+        constexpr double g = 0.5;
+        const double allPassGain = (1.0 - g + g * g) / (1.0 - g);
+        outputGain = static_cast<SampleType>(std::pow(allPassGain, 4 - NumAllPasses) / NumCombs);
+    }
+
+    void setFeedback(float feedback) { combBank.setFeedback(feedback); }
+    void setDamping(float damping) { combBank.setDamping(damping); }
+
+    // 一番長いコムの遅延（ミリ秒、テールの長さの見積もり用）
+    float getLongestCombDelayMs() const { return longestCombDelayMs; }
+
+    // 並列コム → クロスフィード → オールパス（input は作業領域として上書きされる）
+    // レーン 2p, 2p+1 がペア p の L/R
+    void process(SampleType* const* input, SampleType* const* output, int numSamples)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+            processCombs(lane, input[lane], output[lane], numSamples);
+        processDiffusion(input, output, numSamples);
+    }
+
+    // 1レーン分の並列コム（レーンごとに独立しているので、別々のレーンなら別のスレッドから同時に呼んでよい）
+    void processCombs(int lane, const SampleType* input, SampleType* output, int numSamples)
+    {
+        StageProfiler::ScopedStage profileStage(StageProfiler::Stage::Combs);
+        combBank.processChannel(lane, input, output, numSamples);
+        juce::FloatVectorOperations::multiply(output, outputGain, numSamples);
+    }
+
+    // 全レーンのコムの出力（output）にクロスフィード → オールパス（input は作業領域として上書きされる）
+    void processDiffusion(SampleType* const* input, SampleType* const* output, int numSamples)
+    {
+        // ペア内のクロスフィード（ステレオイメージを自然にする）
+        {
+            StageProfiler::ScopedStage profileStage(StageProfiler::Stage::Crossfeed);
+            const auto crossFeedAmount = static_cast<SampleType>(0.15f);
+            for (int p = 0; p < numLanes / 2; ++p)
+            {
+                SampleType* outputL = output[p * 2];
+                SampleType* outputR = output[p * 2 + 1];
+                juce::FloatVectorOperations::copy(input[p * 2], outputL, numSamples);
+                juce::FloatVectorOperations::addWithMultiply(outputL, outputR, crossFeedAmount, numSamples);
+                juce::FloatVectorOperations::addWithMultiply(outputR, input[p * 2], crossFeedAmount, numSamples);
+            }
+        }
+
+        // レーン独立したオールパスフィルターで拡散
+        StageProfiler::ScopedStage profileStage(StageProfiler::Stage::AllPass);
+        for (int lane = 0; lane < numLanes; ++lane)
+            for (auto& ap : allPassFilters[lane])
+                ap.processBlock(output[lane], output[lane], numSamples);
+    }
+
+    void clear()
+    {
+        combBank.clear();
+        for (int lane = 0; lane < numLanes; ++lane)
+            for (auto& ap : allPassFilters[lane])
+                ap.clear();
+    }
+
+private:
+    // コムの遅延時間（ミリ秒、素数寄りの値で金属音を避ける。右は左より少し長くしてステレオ感を出す）
+    static const float* combDelaysMs(bool right)
+    {
+        static const float left4[4]   = { 29.7f, 41.1f, 47.3f, 59.3f };
+        static const float right4[4]  = { 31.1f, 43.3f, 51.7f, 63.1f };
+        static const float left8[8]   = { 29.7f, 37.1f, 41.1f, 43.7f, 47.3f, 53.9f, 59.3f, 61.7f };
+        static const float right8[8]  = { 31.1f, 39.7f, 43.3f, 47.1f, 51.7f, 57.3f, 63.1f, 67.9f };
+        static const float left16[16] = { 29.7f, 37.1f, 41.1f, 43.7f, 47.3f, 53.9f, 59.3f, 61.7f,
+                                          27.1f, 31.7f, 35.3f, 39.1f, 45.1f, 50.3f, 56.9f, 65.3f };
+        static const float right16[16] = { 31.1f, 39.7f, 43.3f, 47.1f, 51.7f, 57.3f, 63.1f, 67.9f,
+                                           28.3f, 33.7f, 36.7f, 40.9f, 49.1f, 55.1f, 60.7f, 71.3f };
+        if constexpr (NumCombs == 4)
+            return right ? right4 : left4;
+        else if constexpr (NumCombs == 8)
+            return right ? right8 : left8;
+        else
+            return right ? right16 : left16;
+    }
+
+    // オールパスの遅延時間（ミリ秒）
+    static const float* allPassDelaysMs(bool right)
+    {
+        static const float left6[6]  = { 5.0f, 6.7f, 10.0f, 12.4f, 3.7f, 15.1f };
+        static const float right6[6] = { 5.3f, 7.1f, 11.3f, 13.7f, 4.1f, 16.3f };
+        static const float leftEco[2]  = { 6.7f, 12.4f };
+        static const float rightEco[2] = { 7.1f, 13.7f };
+        static_assert(NumAllPasses <= 6, "ClassicTank supports up to 6 all-pass stages");
+        if constexpr (NumAllPasses == 2)
+            return right ? rightEco : leftEco;
+        else
+            return right ? right6 : left6;
+    }
+
+    CombBank<SampleType, NumCombs> combBank;   // レーンごとに NumCombs 本のコムフィルター（SoA）
+    std::array<std::array<AllPassFilter<SampleType>, NumAllPasses>, maxLanes> allPassFilters;
+    int numLanes = 2;
+    SampleType outputGain = SampleType(0.125);
+    float longestCombDelayMs = 67.9f;
+};
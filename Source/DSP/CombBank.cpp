@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    CombBank.cpp
+    コムフィルターバンクの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "CombBank.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
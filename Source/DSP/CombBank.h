@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+    CombBank.h
+    コムフィルターバンク - 全チャンネルのコムフィルターを1つの構造でまとめて処理
+
+    CombFilter をチャンネル × CombsPerChannel 個並べる代わりに、読み書き位置・ダンピング状態・
+    フィードバック量をレーン（コム1本 = 1レーン）ごとの配列で保持する
+    （Structure of Arrays）。各ステップの演算はレーン方向のループになるため、
+    コンパイラが SSE/AVX で 8〜16 レーンずつまとめて計算できる。
+
+    レーン配置: lane = channel * combsPerChannel + comb
+    1チャンネル分の8レーンがちょうど AVX 1レジスタになる（double では2レジスタ）。
+    SampleType は float / double（遅延線・状態・演算の型）。
+    CombsPerChannel（4 / 8 / 16）はコンパイル時の定数で、本数ごとにループを展開した処理になる。
+    遅延線は DelaySlab から切り出し、長さは各レーンの遅延 + 1 を2の累乗に切り上げたもの
+    （読み書き位置の折り返しはマスク）。
+  ==============================================================================
+*/
+
+#pragma once
+#include "DelaySlab.h"
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+template <typename SampleType, int CombsPerChannel = 8>
+class CombBank
+{
+public:
+    static_assert(CombsPerChannel == 4 || CombsPerChannel == 8 || CombsPerChannel == 16,
+                  "CombBank supports 4, 8 or 16 combs per channel");
+    static constexpr int combsPerChannel = CombsPerChannel;
+    static constexpr int maxChannels = 16;
+    static constexpr int maxLanes = maxChannels * combsPerChannel;
+
+    CombBank() = default;
+    ~CombBank() = default;
+
+    // サンプルレート・チャンネル数と各レーンの遅延時間
+    // （ミリ秒、numChannels * combsPerChannel 個）で、遅延線を slab から切り出して初期化
+    // （slab.layout() の中から呼ぶ）
+    void prepare(double newSampleRate, const float* delayTimesMs, int newNumChannels,
+                 DelaySlab<SampleType>& slab)
+    {
+        sampleRate = newSampleRate;
+        numChannels = std::clamp(newNumChannels, 1, maxChannels);
+
+        for (int lane = 0; lane < getNumLanes(); ++lane)
+        {
+            const int delaySamples = std::max(1, static_cast<int>(delayTimesMs[lane] * sampleRate / 1000.0));
+            const int size = DelaySlab<SampleType>::powerOfTwoLength(delaySamples + 1);
+
+            lines[lane] = slab.allocate(size);
+            lineMask[lane] = size - 1;
+            writeIndex[lane] = 0;
+            readIndex[lane] = size - delaySamples;
+            filterStore[lane] = SampleType(0);
+        }
+
+        for (int lane = getNumLanes(); lane < maxLanes; ++lane)
+        {
+            lines[lane] = nullptr;
+            lineMask[lane] = 0;
+        }
+    }
+
+    int getNumChannels() const { return numChannels; }
+    int getNumLanes() const { return numChannels * combsPerChannel; }
+
+    // フィードバック量を設定（0.0 - 0.99、全レーン共通）
+    void setFeedback(float fb)
+    {
+        std::fill(std::begin(feedback), std::end(feedback), static_cast<SampleType>(std::clamp(fb, 0.0f, 0.99f)));
+    }
+
+    // ダンピング（高域減衰）を設定（全レーン共通）
+    void setDamping(float damp)
+    {
+        const float d = std::clamp(damp, 0.0f, 1.0f);
+        std::fill(std::begin(damping), std::end(damping), static_cast<SampleType>(d));
+        std::fill(std::begin(dampingInv), std::end(dampingInv), static_cast<SampleType>(1.0f - d));
+    }
+
+    // ブロック処理（各チャンネルの入力 → 各チャンネル combsPerChannel 本の合計を出力）
+    void processBlock(const SampleType* const* inputs, SampleType* const* outputs, int numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            processChannel(ch, inputs[ch], outputs[ch], numSamples);
+    }
+
+    // ステレオ用（2チャンネルで prepare したとき）
+    void processBlock(const SampleType* inputL, const SampleType* inputR,
+                      SampleType* outputL, SampleType* outputR, int numSamples)
+    {
+        processChannel(0, inputL, outputL, numSamples);
+        processChannel(1, inputR, outputR, numSamples);
+    }
+
+    // バッファをクリア（prepare() 前は何もしない）
+    void clear()
+    {
+        for (int lane = 0; lane < getNumLanes(); ++lane)
+            if (lines[lane] != nullptr)
+                std::fill(lines[lane], lines[lane] + lineMask[lane] + 1, SampleType(0));
+        std::fill(std::begin(filterStore), std::end(filterStore), SampleType(0));
+    }
+
+    // 1チャンネル分（combsPerChannel レーン）をブロック処理する。
+    // 状態はブロックの間だけローカル配列に載せ、レジスタ上で回す。
+    // 触るのはそのチャンネルのレーンだけなので、別々のチャンネルなら別のスレッドから同時に呼んでよい
+    void processChannel(int channel, const SampleType* input, SampleType* output, int numSamples)
+    {
+        constexpr int n = combsPerChannel;
+        const int first = channel * n;
+
+        SampleType* line[n];
+        alignas(32) int mask[n], r[n], w[n];
+        alignas(32) SampleType fb[n], damp[n], dampInv[n], store[n];
+
+        for (int c = 0; c < n; ++c)
+        {
+            line[c] = lines[first + c];
+            mask[c] = lineMask[first + c];
+            r[c] = readIndex[first + c];
+            w[c] = writeIndex[first + c];
+            fb[c] = feedback[first + c];
+            damp[c] = damping[first + c];
+            dampInv[c] = dampingInv[first + c];
+            store[c] = filterStore[first + c];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            alignas(32) SampleType delayed[n];
+            const SampleType in = input[i];
+
+            // 遅延信号を取得（レーンごとに読み取り位置が異なるのでギャザー）
+            for (int c = 0; c < n; ++c)
+                delayed[c] = line[c][r[c]];
+
+            // ローパスフィルター（ダンピング）とフィードバック（ベクトル化される）
+            alignas(32) SampleType toWrite[n];
+            for (int c = 0; c < n; ++c)
+            {
+                store[c] = delayed[c] * dampInv[c] + store[c] * damp[c];
+                toWrite[c] = in + store[c] * fb[c];
+            }
+
+            // フィードバック付きで書き込み（スキャッター）
+            for (int c = 0; c < n; ++c)
+                line[c][w[c]] = toWrite[c];
+
+            // 読み書き位置を進める（マスクで折り返し）
+            for (int c = 0; c < n; ++c)
+            {
+                r[c] = (r[c] + 1) & mask[c];
+                w[c] = (w[c] + 1) & mask[c];
+            }
+
+            // 合計（CombFilter を順に足していたときと同じ順序）
+            SampleType sum = SampleType(0);
+            for (int c = 0; c < n; ++c)
+                sum += delayed[c];
+            output[i] = sum;
+        }
+
+        for (int c = 0; c < n; ++c)
+        {
+            readIndex[first + c] = r[c];
+            writeIndex[first + c] = w[c];
+            filterStore[first + c] = store[c];
+        }
+    }
+
+private:
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+
+    // レーンごとの状態（SoA）
+    SampleType* lines[maxLanes] = {};            // DelaySlab の中
+    alignas(32) int lineMask[maxLanes] = {};     // 長さ - 1（長さは2の累乗）
+    alignas(32) int readIndex[maxLanes] = {};
+    alignas(32) int writeIndex[maxLanes] = {};
+    alignas(32) SampleType feedback[maxLanes] = {};
+    alignas(32) SampleType damping[maxLanes] = {};
+    alignas(32) SampleType dampingInv[maxLanes] = {};
+    alignas(32) SampleType filterStore[maxLanes] = {};
+};
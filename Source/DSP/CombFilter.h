@@ -5,6 +5,7 @@
     
     コムフィルターは入力信号を遅延させてフィードバックするフィルター。
     遅延時間とフィードバック量によってリバーブの特性が決まる。
+    SampleType は float / double（遅延線・状態・演算の型）。
   ==============================================================================
 */
 
@@ -13,6 +14,7 @@
 #include <cmath>
 #include <algorithm>
 
+template <typename SampleType>
 class CombFilter
 {
 public:
@@ -24,8 +26,9 @@ public:
     {
         sampleRate = newSampleRate;
         int maxDelaySamples = static_cast<int>(maxDelayMs * sampleRate / 1000.0);
-        buffer.resize(maxDelaySamples, 0.0f);
+        buffer.assign(maxDelaySamples, SampleType(0));  // 再 prepare 時に古いテールを残さない
         writeIndex = 0;
+        filterStore = SampleType(0);
     }
 
     // 遅延時間を設定（ミリ秒）
@@ -41,17 +44,17 @@ public:
     // フィードバック量を設定（0.0 - 0.99）
     void setFeedback(float fb)
     {
-        feedback = std::clamp(fb, 0.0f, 0.99f);
+        feedback = static_cast<SampleType>(std::clamp(fb, 0.0f, 0.99f));
     }
 
     // ダンピング（高域減衰）を設定
     void setDamping(float damp)
     {
-        damping = std::clamp(damp, 0.0f, 1.0f);
+        damping = static_cast<SampleType>(std::clamp(damp, 0.0f, 1.0f));
     }
 
     // 1サンプル処理
-    float process(float input)
+    SampleType process(SampleType input)
     {
         // 読み取り位置を計算
         int readIndex = writeIndex - delaySamples;
@@ -59,10 +62,10 @@ public:
             readIndex += static_cast<int>(buffer.size());
 
         // 遅延信号を取得
-        float delayed = buffer[readIndex];
+        SampleType delayed = buffer[readIndex];
 
         // ローパスフィルター（ダンピング）を適用
-        filterStore = delayed * (1.0f - damping) + filterStore * damping;
+        filterStore = delayed * (SampleType(1) - damping) + filterStore * damping;
 
         // フィードバック付きで書き込み
         buffer[writeIndex] = input + filterStore * feedback;
@@ -75,19 +78,58 @@ public:
         return delayed;
     }
 
+    // ブロック処理（in と out は同じポインタでもよい）
+    // 読み書き位置がどちらも折り返さない連続区間ごとにまとめて処理するため、
+    // サンプルごとの折り返し分岐がない
+    void processBlock(const SampleType* input, SampleType* output, int numSamples)
+    {
+        const int size = static_cast<int>(buffer.size());
+        SampleType* data = buffer.data();
+
+        int readIndex = writeIndex - delaySamples;
+        if (readIndex < 0)
+            readIndex += size;
+
+        while (numSamples > 0)
+        {
+            const int span = std::min({ numSamples, size - readIndex, size - writeIndex });
+            const SampleType* readPtr = data + readIndex;
+            SampleType* writePtr = data + writeIndex;
+
+            for (int i = 0; i < span; ++i)
+            {
+                const SampleType delayed = readPtr[i];
+                filterStore = delayed * (SampleType(1) - damping) + filterStore * damping;
+                writePtr[i] = input[i] + filterStore * feedback;
+                output[i] = delayed;
+            }
+
+            input += span;
+            output += span;
+            numSamples -= span;
+
+            readIndex += span;
+            if (readIndex >= size)
+                readIndex = 0;
+            writeIndex += span;
+            if (writeIndex >= size)
+                writeIndex = 0;
+        }
+    }
+
     // バッファをクリア
     void clear()
     {
-        std::fill(buffer.begin(), buffer.end(), 0.0f);
-        filterStore = 0.0f;
+        std::fill(buffer.begin(), buffer.end(), SampleType(0));
+        filterStore = SampleType(0);
     }
 
 private:
-    std::vector<float> buffer;
+    std::vector<SampleType> buffer;
     double sampleRate = 44100.0;
     int writeIndex = 0;
     int delaySamples = 1;
-    float feedback = 0.7f;
-    float damping = 0.5f;
-    float filterStore = 0.0f;
+    SampleType feedback = SampleType(0.7);
+    SampleType damping = SampleType(0.5);
+    SampleType filterStore = SampleType(0);
 };
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    DelaySlab.cpp
+    遅延線のメモリの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "DelaySlab.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
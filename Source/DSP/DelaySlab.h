@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+    DelaySlab.h
+    遅延線のメモリ - インスタンスの全遅延線を1回の確保から切り出す
+
+    遅延線ごとに std::vector を持つと、ヒープのあちこちに小さなブロックが散らばり、
+    数百インスタンスを動かしたときのキャッシュの使い方が悪くなる。
+    ここでは layout() に渡した関数（各遅延線の prepare()）を2回呼ぶ:
+      1回目は allocate() が長さを数えるだけで nullptr を返す
+      その合計を 64 バイト境界に揃えて1回だけ確保し（0 で埋める）、
+      2回目で同じ順に前から切り出したポインタを渡す
+    各遅延線の先頭はキャッシュラインの境界に揃う。長さは powerOfTwoLength() で
+    実際の最大遅延から2の累乗に切り上げ、読み書き位置の折り返しはマスクで行う。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <algorithm>
+
+template <typename SampleType>
+class DelaySlab
+{
+public:
+    static constexpr size_t alignment = 64;   // キャッシュライン
+    static constexpr int alignmentSamples = static_cast<int>(alignment / sizeof(SampleType));
+
+    // minSamples 以上の2の累乗（遅延 d サンプルの線なら minSamples = d + 1）
+    static int powerOfTwoLength(int minSamples)
+    {
+        return juce::nextPowerOfTwo(std::max(minSamples, alignmentSamples));
+    }
+
+    // prepareLines() で長さを数えてから確保し、もう一度呼んで切り出す（メモリを確保するので prepare() から）
+    template <typename Function>
+    void layout(Function&& prepareLines)
+    {
+        counting = true;
+        used = 0;
+        prepareLines();
+
+        capacity = used;
+        memory.calloc(static_cast<size_t>(capacity) * sizeof(SampleType) + alignment);
+        const auto address = reinterpret_cast<std::uintptr_t>(memory.get());
+        base = reinterpret_cast<SampleType*>((address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1));
+
+        counting = false;
+        used = 0;
+        prepareLines();
+        jassert(used == capacity);   // 2回の呼び出しで同じ長さを要求すること
+    }
+
+    // numSamples の領域を切り出す（先頭は 64 バイト境界。数えている間は nullptr）
+    SampleType* allocate(int numSamples)
+    {
+        const int length = (std::max(numSamples, 1) + alignmentSamples - 1) / alignmentSamples * alignmentSamples;
+        SampleType* line = counting ? nullptr : base + used;
+        jassert(counting || used + length <= capacity);
+        used += length;
+        return line;
+    }
+
+    // 確保したバイト数（揃えるための余りを除く）
+    size_t getNumBytes() const { return static_cast<size_t>(capacity) * sizeof(SampleType); }
+
+    // ここまでに切り出したバイト数（layout() の2回目の途中で、部品ごとの内訳を取るのに使う）
+    size_t getUsedBytes() const { return static_cast<size_t>(used) * sizeof(SampleType); }
+
+private:
+    juce::HeapBlock<char> memory;
+    SampleType* base = nullptr;
+    int capacity = 0;   // サンプル数
+    int used = 0;
+    bool counting = false;
+};
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    DomeFilterTable.cpp
+    DomeReverb のフィルター係数表の実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "DomeFilterTable.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
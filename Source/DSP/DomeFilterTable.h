@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+    DomeFilterTable.h
+    DomeReverb のフィルター係数表（サンプルレートごとにプロセス全体で共有、読み取り専用）
+
+    Dome Amount は 0.01 刻み（101 段）、ローシェルフの持ち上げ量はプリセットの 4 通り、
+    プリEQ は固定なので、係数はサンプルレートが決まれば全部前もって作れる。
+    各レートの表は最初に get() したとき（最初の prepare()）に1回だけ作り、
+    全インスタンスが shared_ptr で同じ表を参照する。ノブやプリセットの変更は表を引くだけになる。
+    表は作ったあと書き換えないので、オーディオスレッドからロックなしで読んでよい。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cmath>
+
+namespace DomeFilterTable
+{
+    constexpr int amountSteps = 101;   // Dome Amount 0.00 - 1.00（0.01 刻み）
+    constexpr int numPresets = 4;
+    constexpr int numPreEQBands = 7;
+
+    // プリセットごとのローシェルフ（200Hz）の持ち上げ量（DomePreset の順: Arena, Stadium, Hall, Club）
+    constexpr float presetBassBoost[numPresets] = { 1.5f, 1.8f, 1.2f, 2.0f };
+
+    // 正規化済み係数 { b0, b1, b2, a1, a2 }
+    struct Table
+    {
+        double sampleRate = 0.0;
+        float lowPass[amountSteps][5] = {};
+        float lowShelf[numPresets][5] = {};
+        float preEQ[numPreEQBands][5] = {};
+    };
+
+    // ポストのローパス（ノブが上がるほど暗く: 10kHz - 5kHz）
+    inline juce::IIRCoefficients designLowPass(double sampleRate, float amount)
+    {
+        const float cutoff = 10000.0f - amount * 5000.0f;
+        return juce::IIRCoefficients::makeLowPass(sampleRate, cutoff);
+    }
+
+    inline juce::IIRCoefficients designLowShelf(double sampleRate, float bassBoost)
+    {
+        return juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7f, bassBoost);
+    }
+
+    inline std::shared_ptr<const Table> build(double sampleRate)
+    {
+        auto table = std::make_shared<Table>();
+        table->sampleRate = sampleRate;
+
+        auto store = [](float* destination, const juce::IIRCoefficients& c)
+        {
+            std::copy(c.coefficients, c.coefficients + 5, destination);
+        };
+
+        for (int step = 0; step < amountSteps; ++step)
+            store(table->lowPass[step], designLowPass(sampleRate, static_cast<float>(step) / 100.0f));
+
+        for (int p = 0; p < numPresets; ++p)
+            store(table->lowShelf[p], designLowShelf(sampleRate, presetBassBoost[p]));
+
+        // ==========================================================
+        // プリEQ（リバーブ前のEQカーブ）- FL Studio画像に基づく
+        // ==========================================================
+
+        // バンド1（紫/50Hz）: わずかに持ち上げ +1dB
+        store(table->preEQ[0], juce::IIRCoefficients::makeLowShelf(sampleRate, 50.0, 0.7, 1.12f));
+
+        // バンド2（ピンク/100Hz）: 少し下げ -1dB
+        store(table->preEQ[1], juce::IIRCoefficients::makePeakFilter(sampleRate, 100.0, 1.5, 0.89f));
+
+        // バンド3（オレンジ/200Hz）: ディップ -3dB
+        store(table->preEQ[2], juce::IIRCoefficients::makePeakFilter(sampleRate, 200.0, 1.0, 0.71f));
+
+        // バンド4（イエロー/400Hz）: 最も深いカット -4dB
+        store(table->preEQ[3], juce::IIRCoefficients::makePeakFilter(sampleRate, 400.0, 1.2, 0.63f));
+
+        // バンド5（緑/1kHz）: 少し持ち上げ +2dB
+        store(table->preEQ[4], juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, 1.26f));
+
+        // バンド6（水色/4kHz）: 大きなピーク +6dB
+        store(table->preEQ[5], juce::IIRCoefficients::makePeakFilter(sampleRate, 4000.0, 1.5, 2.0f));
+
+        // バンド7（青/10kHz〜）: 急激なローパス
+        store(table->preEQ[6], juce::IIRCoefficients::makeLowPass(sampleRate, 10000.0, 0.5));
+
+        return table;
+    }
+
+    // サンプルレートの表を返す（なければ作る）。ロックを取るので prepare() から呼ぶこと
+    inline std::shared_ptr<const Table> get(double sampleRate)
+    {
+        static std::mutex mutex;
+        static std::map<double, std::shared_ptr<const Table>> tables;
+
+        const std::lock_guard<std::mutex> lock(mutex);
+        auto& table = tables[sampleRate];
+        if (table == nullptr)
+            table = build(sampleRate);
+        return table;
+    }
+
+    // Dome Amount が表の段（0.01 刻み）に乗っていればその段、乗っていなければ -1
+    inline int amountStep(float amount)
+    {
+        const float scaled = amount * 100.0f;
+        const float step = std::round(scaled);
+        return std::abs(scaled - step) < 1.0e-3f ? static_cast<int>(step) : -1;
+    }
+}
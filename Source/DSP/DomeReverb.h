@@ -4,15 +4,63 @@
     ドームライブリバーブ - 東京ドームのようなアリーナ音響をエミュレート
     
     改善版: 真のステレオリバーブ、低域強化、プリセット対応
+
+    多チャンネル（5.1 / 7.1 / 7.1.4 など）では L/R, Ls/Rs, Ltf/Rtf … のペアごとに
+    遅延時間をずらした独立のタンクを持つ。全チャンネルの状態は1つの構造に
+    まとめ、フィルターはチャンネル方向の SIMD レーンで同時に計算する。
+    LFE はリバーブを通さずそのまま出力する。
+    全ての遅延線は prepare() で1つの DelaySlab から切り出す（getMemoryReport() で内訳が分かる）。
+
+    Convolution エンジンでは実測 IR の分割畳み込みを後期残響の代わりに使う
+    （プリEQ と Wet/Dry ミックスはそのまま、プリディレイ・ポストフィルター・幅は IR に含まれるので通さない）。
+
+    88.2kHz 以上では wet の経路（プリEQ 〜 幅）を 1/2 または 1/4 のレート（44.1 / 48kHz）で
+    動かす（ハーフバンド FIR で間引き → タンク → 補間）。dry はそのまま。
+    リサンプラーの遅延はプリディレイから差し引く。
+
+    入力が無音（-120dB 未満）のまま、後期残響の出力も一定時間 -120dB 未満になったら
+    wet の経路を止めて dry だけを通す。止めるときは何も消さない（残っているのは -120dB 未満なので、
+    1MB を超える遅延線をオーディオスレッドで 0 にする必要はない）。入力が戻ったら続きから再開する。
+
+    SampleType は float / double（ホストが倍精度で呼ぶときは DomeReverb<double> を使い、変換のコピーをしない）。
+    ゲインやフィルター係数の設計は float のまま。畳み込み（juce::dsp::FFT が float のみ）だけは
+    double のとき境界で float に変換する。
+
+    Classic エンジンのタンクは品質（Eco / Standard / High）ごとにコム・オールパスの本数を
+    コンパイル時に決めたものを3つ持ち、setQuality() で切り替える（ClassicTank.h）。
+    切り替えた瞬間に wet が途切れないよう、前の品質のタンクは入力を止めたまま qualityFadeSeconds の間
+    鳴らし続け、出力を 0 までフェードして新しいタンクの出力に足す。
+
+    オフラインレンダリング中と内部レートで parallelMinSamples 以上のブロックでは、Classic の
+    プリEQ → プリディレイ → 並列コム（クロスフィードまでレーンごとに独立）を L と R のレーンに分け、
+    R 側を LaneWorker のスレッドで同時に処理する（ワーカーが取りかかっていない R レーンは
+    呼び出したスレッドが取り返す）。クロスフィード以降は呼び出したスレッドで行う。
+
+    Classic / FDN では、プリEQ の後に初期反射（EarlyReflections.h、プリセットごとの部屋の鏡像法で
+    求めた疎なタップ）をレーンごとに通し、プリディレイの出力と一緒に後期残響へ送るとともに、
+    後期残響の出力にも足す（最初の 120ms の定位感を出す）。
+
+    各ステージは StageProfiler::ScopedStage で囲んである（プロファイル用ビルドだけ時間を測る。StageProfiler.h）。
   ==============================================================================
 */
 
 #pragma once
 #include <JuceHeader.h>
-#include "CombFilter.h"
-#include "AllPassFilter.h"
+#include "ClassicTank.h"
+#include "MultichannelBiquadCascade.h"
+#include "FdnTank.h"
+#include "PartitionedConvolver.h"
+#include "HalfBandResampler.h"
+#include "LevelMeter.h"
+#include "LaneWorker.h"
+#include "DomeFilterTable.h"
+#include "EarlyReflections.h"
+#include "StageProfiler.h"
 #include <array>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <type_traits>
 
 // プリセット列挙型
 enum class DomePreset
@@ -23,425 +71,1524 @@ enum class DomePreset
     Club      // ライブハウス風
 };
 
+// 後期残響エンジン
+enum class ReverbEngine
+{
+    Classic,  // 並列コム + オールパス（Schroeder / Freeverb 型）
+    Fdn8,     // 8線 FDN（アダマール行列）
+    Fdn16,    // 16線 FDN（アダマール行列）
+    Convolution  // 実測インパルス応答の分割畳み込み（IR 未設定なら Classic）
+};
+
+// L/R ペアの入出力の形（DomeReverb::prepare() でチャンネル配置から選ぶ）
+enum class PairKernel
+{
+    Stereo,        // L/R それぞれの入力 → L/R の出力
+    MonoToStereo,  // 1つの入力 → L/R の出力（プリEQ・プリディレイ・初期反射の書き込みは1回）
+    MonoToMono     // 1つの入力 → 1つの出力（R は仮想レーン。タンクはクロスフィードと幅のために回す）
+};
+
+template <typename SampleType>
 class DomeReverb
 {
 public:
     DomeReverb() = default;
-    ~DomeReverb() = default;
+    ~DomeReverb()
+    {
+        convolutionWorker.stopThread(1000);
+        laneWorker.stopThread(1000);
+    }
+
+    // 1インスタンスで扱える最大レーン数（7.1.4 = 6ペア = 12レーン）
+    static constexpr int maxLanes = CombBank<SampleType>::maxChannels;
+    static constexpr int maxPairs = maxLanes / 2;
+
+    // 内部レートの間引き率の上限（192kHz → 48kHz）
+    static constexpr int maxRateFactor = 4;
+
+    // L/R のレーンを2スレッドに分けるブロックの長さ（内部レートのサンプル数、オフライン時は常に分ける）
+    static constexpr int parallelMinSamples = 1024;
+
+    // 品質を切り替えたとき、前のタンクを鳴らし切る時間（この間に出力を 1 → 0 へ下げる。
+    // 2つのタンクが同時に動くので、処理時間はこの間だけ増える）
+    static constexpr double qualityFadeSeconds = 0.2;
 
-    // サンプルレートとブロックサイズで初期化
-    void prepare(double newSampleRate, int samplesPerBlock)
+    // サンプルレート・ブロックサイズ・チャンネル配置で初期化
+    // inputLayout は入力の配置（省略時は layout と同じ）。モノラル入力 → ステレオ出力のときは
+    // チャンネル 0 を唯一の入力として両方のレーンに送る（チャンネル 1 の中身は dry としてだけ使う）
+    void prepare(double newSampleRate, int samplesPerBlock,
+                 const juce::AudioChannelSet& layout = juce::AudioChannelSet::stereo(),
+                 const juce::AudioChannelSet& inputLayout = {})
     {
+        convolutionWorker.stopThread(1000);
+        laneWorker.stopThread(1000);
+
         sampleRate = newSampleRate;
+        maxBlockSize = std::max(1, samplesPerBlock);
 
-        // 左チャンネル用遅延時間（素数で設定すると金属音を避けられる）
-        const float combDelaysL[8] = { 
-            29.7f, 37.1f, 41.1f, 43.7f,
-            47.3f, 53.9f, 59.3f, 61.7f
-        };
-        
-        // 右チャンネル用遅延時間（左より少し長くしてステレオ感を出す）
-        const float combDelaysR[8] = { 
-            31.1f, 39.7f, 43.3f, 47.1f,
-            51.7f, 57.3f, 63.1f, 67.9f
-        };
+        buildChannelMap(layout);
+        selectPairKernels(inputLayout.isDisabled() ? layout : inputLayout);
+        const int numLanes = numPairs * 2;
+
+        // 内部レート: 上限を超えていて、半分にしても 44.1kHz 以上なら間引く
+        rateFactor = 1;
+        while (maxInternalSampleRate > 0.0 && rateFactor < maxRateFactor
+               && sampleRate / rateFactor > maxInternalSampleRate
+               && sampleRate / (rateFactor * 2) >= 44100.0)
+            rateFactor *= 2;
+        internalSampleRate = sampleRate / rateFactor;
+        maxInternalBlockSize = (maxBlockSize + rateFactor - 1) / rateFactor;
+
+        // 作業バッファ（ステージ間の受け渡し用）
+        wetBuffer.setSize(numLanes, maxBlockSize, false, true, false);
+        tempBuffer.setSize(numLanes, maxBlockSize, false, true, false);
+        earlyBuffer.setSize(numLanes, maxBlockSize, false, true, false);
+        qualityFadeBuffer.setSize(numLanes * 2, maxInternalBlockSize, false, true, false);
+
+        // 間引き・補間（段数 = log2(rateFactor)）と、補間した wet をホストのブロックに合わせる FIFO。
+        // 内部レートの1サンプル分だけ先に 0 を入れておくと、どんなブロックの分け方でも足りる
+        numResamplerStages = rateFactor == 4 ? 2 : (rateFactor == 2 ? 1 : 0);
+        HalfBand::coefficients();   // 係数表はオーディオスレッドの外で作っておく
+        for (int lane = 0; lane < numLanes; ++lane)
+            upsampledFifo[lane].assign(static_cast<size_t>(maxBlockSize + 2 * rateFactor), SampleType(0));
+        resetResamplers();
+        resetMeters();
+        resetQualityFade();
+        wake();
+
+        // ペアごとに遅延時間を伸ばして、チャンネル間の相関をなくす（最初のペアは L/R そのまま）
+        float laneDelayScale[maxLanes];
+        for (int lane = 0; lane < numLanes; ++lane)
+            laneDelayScale[lane] = pairDelayScale(lane / 2);
 
-        const float allPassDelaysL[4] = { 5.0f, 6.7f, 10.0f, 12.4f };
-        const float allPassDelaysR[4] = { 5.3f, 7.1f, 11.3f, 13.7f };
+        // プリディレイ（短縮: 最大30ms）
+        // ブロック単位で書き込んでから読むので、最大遅延 + 1ブロック分
+        // （+ 遅延時間変化中の補間用に1サンプル）を2の累乗に切り上げた長さ
+        maxPreDelaySamples = static_cast<int>(maxPreDelaySeconds * internalSampleRate);
+        const int preDelaySize = DelaySlab<SampleType>::powerOfTwoLength(maxPreDelaySamples + maxInternalBlockSize + 1);
+        preDelayMask = preDelaySize - 1;
 
-        // 左チャンネルのコムフィルターを初期化
-        for (int i = 0; i < 8; ++i)
+        // 遅延線はすべて1つの DelaySlab から切り出す（確保し直すので全体が 0 になり、古いテールは残らない）
+        // 品質・エンジンの切り替えをオーディオスレッドで確保なしに行うため、使っていないタンクもすべて持つ。
+        // ステレオ 48kHz で約 1.4MB（Classic 790KB + FDN 576KB + プリディレイ 32KB + 初期反射 64KB）。
+        // 使うものだけなら Standard で約 330KB なので、残りの約 1.1MB が切り替えのための分
+        delaySlab.layout([&]
         {
-            combFiltersL[i].prepare(sampleRate, 150.0f);
-            combFiltersL[i].setDelayTime(combDelaysL[i]);
-            combFiltersL[i].setFeedback(0.82f);
-            combFiltersL[i].setDamping(0.3f);
-        }
+            // Classic のタンク（品質の切り替え・ガバナー用、切り替えたときに前のタンクを鳴らし切るため3つとも）
+            ecoTank.prepare(internalSampleRate, numLanes, laneDelayScale, delaySlab);
+            standardTank.prepare(internalSampleRate, numLanes, laneDelayScale, delaySlab);
+            highTank.prepare(internalSampleRate, numLanes, laneDelayScale, delaySlab);
+            memoryReport.classicTanks = delaySlab.getUsedBytes();
+
+            // FDN タンク（エンジン切り替え用に両方用意しておく、ペアごとに1つ）
+            for (int p = 0; p < numPairs; ++p)
+            {
+                fdn8[p].prepare(internalSampleRate, delaySlab, pairDelayScale(p));
+                fdn16[p].prepare(internalSampleRate, delaySlab, pairDelayScale(p));
+            }
+            memoryReport.fdnTanks = delaySlab.getUsedBytes() - memoryReport.classicTanks;
+
+            // 入力を共有するレーンは L レーンの遅延線を読むだけ（切り出さない）
+            int numPreDelayLines = 0;
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                if (sharesInput(lane))
+                {
+                    preDelayLines[lane] = preDelayLines[lane - 1];
+                    continue;
+                }
+                preDelayLines[lane] = delaySlab.allocate(preDelaySize);
+                ++numPreDelayLines;
+            }
+            memoryReport.preDelay = static_cast<size_t>(numPreDelayLines * preDelaySize) * sizeof(SampleType);
+
+            // 初期反射（ペアごとに遅延を伸ばすぶんも入る長さで）
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                if (sharesInput(lane))
+                    earlyReflections[lane].prepareShared(earlyReflections[lane - 1]);
+                else
+                    earlyReflections[lane].prepare(internalSampleRate, maxInternalBlockSize, delaySlab, pairDelayScale(lane / 2));
+            }
+            memoryReport.earlyReflections = delaySlab.getUsedBytes() - memoryReport.classicTanks
+                                          - memoryReport.fdnTanks - memoryReport.preDelay;
+        });
+        memoryReport.delaySlab = delaySlab.getNumBytes();
 
-        // 右チャンネルのコムフィルターを初期化
-        for (int i = 0; i < 8; ++i)
+        for (int lane = 0; lane < numLanes; ++lane)
         {
-            combFiltersR[i].prepare(sampleRate, 150.0f);
-            combFiltersR[i].setDelayTime(combDelaysR[i]);
-            combFiltersR[i].setFeedback(0.82f);
-            combFiltersR[i].setDamping(0.3f);
+            preDelayWriteIndex[lane] = 0;
+
+            // ノブ 100% のときの遅延（ミリ秒）: L 25ms / R 30ms をペアごとに伸ばす
+            preDelayMsAtFullAmount[lane] = ((lane % 2 == 0) ? 25.0f : 30.0f) * pairDelayScale(lane / 2);
         }
+        designPresetEarlyReflections();
+        applyPresetEarlyReflections(0);
+
+        // フィルター係数（サンプルレートごとに全インスタンスで共有する表から。
+        // ポストフィルターは最初の process() で目標値に揃える）
+        filterTable = DomeFilterTable::get(internalSampleRate);
+        for (int band = 0; band < numPreEQSections; ++band)
+            filters.setSection(preEQFirstSection + band, filterTable->preEQ[band]);
+
+        filters.prepare(numLanes, maxInternalBlockSize);
 
-        // 左チャンネルのオールパスフィルターを初期化
-        for (int i = 0; i < 4; ++i)
+        // 倍精度のときだけ、畳み込みの入出力を float にする作業バッファ（L/R の入力と出力）
+        if constexpr (! std::is_same_v<SampleType, float>)
+            convolutionScratch.setSize(4, maxBlockSize, false, true, false);
+
+        // パラメータのスムージング（次の process() の最初で目標値に揃える）
+        smoothedAmount.reset(sampleRate, smoothingTimeSeconds);
+        smoothedWidth.reset(sampleRate, smoothingTimeSeconds);
+        smoothedEarlyLevel.reset(sampleRate, smoothingTimeSeconds);
+        designPostFilterTargets();
+        needsSnap = true;
+
+        // L/R のレーンを分けて処理するワーカー（分ける条件を満たしうるとき、コアが2つ以上あれば動かす）
+        if (parallelLanes && (nonRealtime || maxInternalBlockSize >= parallelMinSamples)
+            && juce::SystemStats::getNumCpus() > 1)
+            laneWorker.startThread(juce::Thread::Priority::high);
+
+        // 同じサンプルレートの IR はペア数に合わせて作り直す（違うレートの IR は外す）
+        setImpulseResponse(impulseResponse);
+    }
+
+    // ワーカースレッドを止める（使わないインスタンス用、次の prepare() で必要なら動かし直す）
+    void stopThreads()
+    {
+        convolutionWorker.stopThread(1000);
+        laneWorker.stopThread(1000);
+    }
+
+    // 畳み込み用のインパルス応答を設定（nullptr で解除）
+    // メモリを確保しスレッドを止めるので、process() と同時に呼ばないこと
+    void setImpulseResponse(std::shared_ptr<const ConvolutionIR> newImpulseResponse)
+    {
+        convolutionWorker.stopThread(1000);
+
+        if (newImpulseResponse != nullptr && newImpulseResponse->getSampleRate() != internalSampleRate)
+            newImpulseResponse = nullptr;
+        impulseResponse = std::move(newImpulseResponse);
+
+        std::vector<PartitionedConvolver*> active;
+        for (int p = 0; p < maxPairs; ++p)
         {
-            allPassFiltersL[i].prepare(sampleRate, 30.0f);
-            allPassFiltersL[i].setDelayTime(allPassDelaysL[i]);
-            allPassFiltersL[i].setCoefficient(0.5f);
+            convolvers[p].prepare(p < numPairs ? impulseResponse : nullptr, nonRealtime);
+            if (p < numPairs)
+                active.push_back(&convolvers[p]);
         }
 
-        // 右チャンネルのオールパスフィルターを初期化
-        for (int i = 0; i < 4; ++i)
+        // テール区間はワーカースレッドで計算（オフライン時は process() 内で同期して計算）
+        if (impulseResponse != nullptr && impulseResponse->hasTail() && ! nonRealtime)
         {
-            allPassFiltersR[i].prepare(sampleRate, 30.0f);
-            allPassFiltersR[i].setDelayTime(allPassDelaysR[i]);
-            allPassFiltersR[i].setCoefficient(0.5f);
+            convolutionWorker.setConvolvers(std::move(active));
+            convolutionWorker.startThread(juce::Thread::Priority::high);
         }
+        updateTailLength();
+    }
 
-        // プリディレイ（短縮: 最大30ms）
-        int maxPreDelaySamples = static_cast<int>(50.0f * sampleRate / 1000.0f);
-        preDelayBufferL.resize(maxPreDelaySamples, 0.0f);
-        preDelayBufferR.resize(maxPreDelaySamples, 0.0f);
-        preDelayWriteIndexL = 0;
-        preDelayWriteIndexR = 0;
-
-        // ローパスフィルター（L/R独立）
-        lowPassFilterL.setCoefficients(
-            juce::IIRCoefficients::makeLowPass(sampleRate, 8000.0)
-        );
-        lowPassFilterR.setCoefficients(
-            juce::IIRCoefficients::makeLowPass(sampleRate, 8000.0)
-        );
-
-        // ローシェルフフィルター（低域強化）
-        lowShelfFilterL.setCoefficients(
-            juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7f, 1.5f)
-        );
-        lowShelfFilterR.setCoefficients(
-            juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7f, 1.5f)
-        );
+    bool hasImpulseResponse() const { return impulseResponse != nullptr; }
+    const std::shared_ptr<const ConvolutionIR>& getImpulseResponse() const { return impulseResponse; }
 
-        // ==========================================================
-        // プリEQ（リバーブ前のEQカーブ）- FL Studio画像に基づく
-        // ==========================================================
-        
-        // バンド1（紫/50Hz）: わずかに持ち上げ +1dB
-        preEQ_Band1L.setCoefficients(
-            juce::IIRCoefficients::makeLowShelf(sampleRate, 50.0, 0.7, 1.12f) // +1dB
-        );
-        preEQ_Band1R.setCoefficients(
-            juce::IIRCoefficients::makeLowShelf(sampleRate, 50.0, 0.7, 1.12f)
-        );
-
-        // バンド2（ピンク/100Hz）: 少し下げ -1dB
-        preEQ_Band2L.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 100.0, 1.5, 0.89f) // -1dB
-        );
-        preEQ_Band2R.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 100.0, 1.5, 0.89f)
-        );
-
-        // バンド3（オレンジ/200Hz）: ディップ -3dB
-        preEQ_Band3L.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 200.0, 1.0, 0.71f) // -3dB
-        );
-        preEQ_Band3R.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 200.0, 1.0, 0.71f)
-        );
-
-        // バンド4（イエロー/400Hz）: 最も深いカット -4dB
-        preEQ_Band4L.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 400.0, 1.2, 0.63f) // -4dB
-        );
-        preEQ_Band4R.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 400.0, 1.2, 0.63f)
-        );
-
-        // バンド5（緑/1kHz）: 少し持ち上げ +2dB
-        preEQ_Band5L.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, 1.26f) // +2dB
-        );
-        preEQ_Band5R.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, 1.26f)
-        );
-
-        // バンド6（水色/4kHz）: 大きなピーク +6dB
-        preEQ_Band6L.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 4000.0, 1.5, 2.0f) // +6dB
-        );
-        preEQ_Band6R.setCoefficients(
-            juce::IIRCoefficients::makePeakFilter(sampleRate, 4000.0, 1.5, 2.0f)
-        );
-
-        // バンド7（青/10kHz〜）: 急激なローパス
-        preEQ_Band7L.setCoefficients(
-            juce::IIRCoefficients::makeLowPass(sampleRate, 10000.0, 0.5)
-        );
-        preEQ_Band7R.setCoefficients(
-            juce::IIRCoefficients::makeLowPass(sampleRate, 10000.0, 0.5)
-        );
+    // wet の経路を動かすレートの上限（0 で常にホストのレート、次の prepare() から反映）
+    void setMaxInternalSampleRate(double newMaxRate) { maxInternalSampleRate = newMaxRate; }
+
+    // wet の経路のサンプルレート（畳み込みの IR はこのレートで作る）
+    double getInternalSampleRate() const { return internalSampleRate; }
+
+    // オフラインレンダリングかどうか（次の prepare() / setImpulseResponse() から反映）
+    void setNonRealtime(bool shouldBeNonRealtime) { nonRealtime = shouldBeNonRealtime; }
+
+    // L/R のレーンを2スレッドに分けてよいか（デフォルト true、次の prepare() から反映）
+    // 呼び出し側がすでにコアの数だけインスタンスを並列に動かしているときは false にする
+    void setParallelLanes(bool shouldUseParallelLanes) { parallelLanes = shouldUseParallelLanes; }
+
+    // ワーカーが間に合わずテールを落としたブロック数（全ペアの合計）
+    int getNumConvolutionUnderruns() const
+    {
+        int total = 0;
+        for (int p = 0; p < numPairs; ++p)
+            total += convolvers[p].getNumUnderruns();
+        return total;
     }
 
     // ドーム感の量を設定（0.0 - 1.0）
+    // 値が変わったときだけ目標係数を設計し直し、実際の変化は process() 内で滑らかに行う
     void setDomeAmount(float amount)
     {
-        domeAmount = std::clamp(amount, 0.0f, 1.0f);
-        updateParameters();
+        amount = std::clamp(amount, 0.0f, 1.0f);
+        if (amount == smoothedAmount.getTargetValue())
+            return;
+
+        smoothedAmount.setTargetValue(amount);
+        designPostFilterTargets();
+        updateTailLength();
     }
 
-    float getDomeAmount() const { return domeAmount; }
+    float getDomeAmount() const { return smoothedAmount.getTargetValue(); }
 
-    // プリセットを適用
+    // プリセットを適用（オーディオスレッドから呼ぶ。process() と同時に別のスレッドから呼ばないこと）
+    // 設計済みの値に切り替えるだけなので重い計算はしない。量・幅・ローシェルフ・初期反射のレベルは
+    // ほかのパラメータと同じく滑らかに変え、初期反射のタップは古い組とクロスフェードする
     void setPreset(DomePreset preset)
     {
+        const bool changed = preset != currentPreset;
         currentPreset = preset;
+        float amount = 0.6f;
+        float width = 0.8f;
         switch (preset)
         {
             case DomePreset::Arena:
-                domeAmount = 0.6f;
-                stereoWidth = 0.8f;
-                bassBoost = 1.5f;
+                amount = 0.6f;
+                width = 0.8f;
                 break;
             case DomePreset::Stadium:
-                domeAmount = 0.8f;
-                stereoWidth = 1.0f;
-                bassBoost = 1.8f;
+                amount = 0.8f;
+                width = 1.0f;
                 break;
             case DomePreset::Hall:
-                domeAmount = 0.4f;
-                stereoWidth = 0.6f;
-                bassBoost = 1.2f;
+                amount = 0.4f;
+                width = 0.6f;
                 break;
             case DomePreset::Club:
-                domeAmount = 0.25f;
-                stereoWidth = 0.5f;
-                bassBoost = 2.0f;
+                amount = 0.25f;
+                width = 0.5f;
                 break;
         }
-        updateParameters();
+        smoothedAmount.setTargetValue(amount);
+        smoothedWidth.setTargetValue(width);
+        designPostFilterTargets();
+        updateTailLength();
+
+        // prepare() 直後は最初の process() で揃えるのでフェードしない
+        if (changed || needsSnap)
+            applyPresetEarlyReflections(needsSnap ? 0 : static_cast<int>(smoothingTimeSeconds * internalSampleRate));
     }
 
     DomePreset getPreset() const { return currentPreset; }
 
+    // 後期残響エンジンを切り替え（切り替え先のタンクは空の状態から始める）
+    void setEngine(ReverbEngine newEngine)
+    {
+        if (newEngine == engine)
+            return;
+
+        // Convolution ではプリディレイを通さないので、出入りするときは古い入力が残らないよう空にする
+        if (engine == ReverbEngine::Convolution || newEngine == ReverbEngine::Convolution)
+        {
+            for (int lane = 0; lane < numPairs * 2; ++lane)
+            {
+                clearPreDelay(lane);
+                earlyReflections[lane].clear();
+            }
+        }
+
+        engine = newEngine;
+        switch (engine)
+        {
+            case ReverbEngine::Convolution:
+                for (int p = 0; p < numPairs; ++p)
+                    convolvers[p].reset();
+                [[fallthrough]];   // IR 未設定のときは Classic で鳴らす
+
+            case ReverbEngine::Classic:
+                withClassicTank([](auto& tank) { tank.clear(); });
+                resetQualityFade();
+                break;
+
+            case ReverbEngine::Fdn8:
+            case ReverbEngine::Fdn16:
+                for (int p = 0; p < numPairs; ++p)
+                {
+                    fdn8[p].clear();
+                    fdn16[p].clear();
+                }
+                updateFdnDecay(smoothedAmount.getCurrentValue());
+                break;
+        }
+        updateTailLength();
+    }
+
+    ReverbEngine getEngine() const { return engine; }
+
+    // Classic エンジンの品質を切り替え（どの品質のタンクも prepare() で用意してあるので、
+    // ガバナーと同じくオーディオスレッドから呼んでよい）
+    // 前の品質のタンクは入力を止めて鳴らし続け、qualityFadeSeconds でフェードアウトする。
+    // 切り替え先は空の状態から始める（まだフェードアウト中のタンクに戻るときは、残っている音から 1 へ戻す）
+    void setQuality(ReverbQuality newQuality)
+    {
+        if (newQuality == quality)
+            return;
+
+        quality = newQuality;
+        withClassicTank([this](auto& tank)
+        {
+            if (qualityGain[static_cast<size_t>(quality)] == 0.0f)
+            {
+                tank.clear();
+                qualityGain[static_cast<size_t>(quality)] = 1.0f;
+            }
+            tank.setFeedback(combFeedback);
+            tank.setDamping(combDamping);
+        });
+
+        // prepare() 直後と止めている間はタンクが鳴っていないので、フェードしない
+        if (needsSnap || sleeping)
+            resetQualityFade();
+        updateTailLength();
+    }
+
+    ReverbQuality getQuality() const { return quality; }
+
+    // リバーブを掛けるペア数（LFE を除いたチャンネルを L/R の組にしたもの）
+    int getNumPairs() const { return numPairs; }
+
+    // ペア p の入出力の形（prepare() で決まる）
+    PairKernel getPairKernel(int p) const { return pairKernel[p]; }
+
+    // 前回 resetMeters() してからの wet（wetGain 込み）と後期残響の出力のレベル
+    const LevelMeter::Accumulator& getWetMeter() const { return wetMeter; }
+    const LevelMeter::Accumulator& getTankMeter() const { return tankMeter; }
+
+    // 1インスタンスのメモリの内訳（バイト）
+    // 遅延線はすべて delaySlab の1回の確保の中（キャッシュライン境界に揃え、長さは2の累乗）
+    struct MemoryReport
+    {
+        size_t classicTanks = 0;       // Eco / Standard / High のコム・オールパス
+        size_t fdnTanks = 0;           // FDN 8 / 16（ペアごと）
+        size_t preDelay = 0;
+        size_t earlyReflections = 0;
+        size_t delaySlab = 0;          // 上の4つの合計
+        size_t workBuffers = 0;        // ステージ間の作業バッファ、品質を切り替えるときのフェード用、補間した wet の FIFO
+
+        size_t total() const { return delaySlab + workBuffers; }   // 畳み込み（IR は共有）は含まない
+    };
+
+    MemoryReport getMemoryReport() const
+    {
+        MemoryReport report = memoryReport;
+        for (const auto* buffer : { &wetBuffer, &tempBuffer, &earlyBuffer, &qualityFadeBuffer })
+            report.workBuffers += static_cast<size_t>(buffer->getNumChannels() * buffer->getNumSamples()) * sizeof(SampleType);
+        for (const auto& fifo : upsampledFifo)
+            report.workBuffers += fifo.size() * sizeof(SampleType);
+        return report;
+    }
+
+    void resetMeters()
+    {
+        wetMeter.reset();
+        tankMeter.reset();
+    }
+
     // オーディオバッファを処理
-    void process(juce::AudioBuffer<float>& buffer)
+    void process(juce::AudioBuffer<SampleType>& buffer)
     {
         const int numChannels = buffer.getNumChannels();
         const int numSamples = buffer.getNumSamples();
+        const int numLanes = numPairs * 2;
 
         if (numChannels == 0) return;
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        // デノーマル対策（フィルターの状態はブロック末尾で丸めないので、ここで FTZ / DAZ にする）
+        juce::ScopedNoDenormals noDenormals;
+        StageProfiler::ScopedStage profileBlock(StageProfiler::Stage::Process, numSamples);
+
+        if (needsSnap)
+            snapParametersToTargets();
+
+        // prepare() で確保した作業バッファに収まるよう分割して処理。
+        // パラメータ変化中は制御ブロック（controlBlockSize）単位で値を進める
+        int start = 0;
+        while (start < numSamples)
         {
-            // ステレオ入力を取得
-            float inputL = buffer.getSample(0, sample);
-            float inputR = numChannels > 1 ? buffer.getSample(1, sample) : inputL;
+            int n = std::min(maxBlockSize, numSamples - start);
 
-            // ==========================================================
-            // プリEQを適用（リバーブに送る前のEQカーブ）
-            // ==========================================================
-            float eqL = inputL;
-            float eqR = inputR;
+            if (isSmoothing())
+            {
+                n = std::min(n, controlBlockSize);
+                advanceParameters(n);
+            }
+            else
+            {
+                holdParameters();
+            }
 
-            // バンド1（50Hz）: わずかに持ち上げ
-            eqL = preEQ_Band1L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band1R.processSingleSampleRaw(eqR);
+            // レーン → バッファのチャンネル（片割れのないレーンやバッファにないチャンネルは nullptr）
+            SampleType* io[maxLanes] = {};
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const int ch = laneChannel[lane];
+                io[lane] = (ch >= 0 && ch < numChannels) ? buffer.getWritePointer(ch, start) : nullptr;
+            }
 
-            // バンド2（100Hz）: 少し下げ
-            eqL = preEQ_Band2L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band2R.processSingleSampleRaw(eqR);
+            // 無音が続いて残響も消えていたら dry だけ通す
+            updateSleepState(io, n);
+            if (sleeping)
+            {
+                processDryOnly(io, n);
+            }
+            else
+            {
+                chunkTankPeak = 0.0f;
+                processChunk(io, n);
+                quietTankSamples = chunkTankPeak < silenceThreshold ? std::min(quietTankSamples + n, maxCount) : 0;
+            }
+            start += n;
+        }
+    }
 
-            // バンド3（200Hz）: ディップ
-            eqL = preEQ_Band3L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band3R.processSingleSampleRaw(eqR);
+    // 残響が消えるまでの時間（秒）: 入力が止まってから -120dB（RT60 の2倍）まで落ちるのにかかる時間
+    // エンジン・品質・ノブ・IR を変えたときに計算して公開した値なので、どのスレッドから読んでもよい
+    double getTailLengthSeconds() const
+    {
+        return tailLengthSeconds.load(std::memory_order_relaxed);
+    }
 
-            // バンド4（400Hz）: 最も深いカット
-            eqL = preEQ_Band4L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band4R.processSingleSampleRaw(eqR);
+    // 無音で wet の経路を止めているか
+    bool isSleeping() const { return sleeping; }
 
-            // バンド5（1kHz）: 少し持ち上げ
-            eqL = preEQ_Band5L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band5R.processSingleSampleRaw(eqR);
+    // バッファをクリア
+    void clear()
+    {
+        withClassicTank([](auto& tank) { tank.clear(); });
+        for (int p = 0; p < numPairs; ++p)
+        {
+            fdn8[p].clear();
+            fdn16[p].clear();
+            convolvers[p].reset();
+        }
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+        {
+            clearPreDelay(lane);
+            earlyReflections[lane].clear();
+        }
+        filters.reset();
+        resetResamplers();
+        resetMeters();
+        resetQualityFade();
+        wake();
+    }
 
-            // バンド6（4kHz）: 大きなピーク
-            eqL = preEQ_Band6L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band6R.processSingleSampleRaw(eqR);
+private:
+    // チャンネル配置から L/R ペアを作る。
+    // 対になる種類（Ls/Rs など）がないチャンネル（C、モノラル）は、
+    // 仮想の右レーンが同じ入力を共有してタンクを回し、その出力は捨てる（PairKernel::MonoToMono）
+    void buildChannelMap(const juce::AudioChannelSet& layout)
+    {
+        using Type = juce::AudioChannelSet::ChannelType;
 
-            // バンド7（10kHz〜）: ローパス
-            eqL = preEQ_Band7L.processSingleSampleRaw(eqL);
-            eqR = preEQ_Band7R.processSingleSampleRaw(eqR);
+        const int numLayoutChannels = layout.size();
+        std::array<bool, 64> assigned {};
+        numPairs = 0;
 
-            // プリディレイを適用（L/R独立）- EQ処理済みの信号を使用
-            float preDelayedL = processPreDelay(eqL, preDelayBufferL, preDelayWriteIndexL, preDelaySamplesL);
-            float preDelayedR = processPreDelay(eqR, preDelayBufferR, preDelayWriteIndexR, preDelaySamplesR);
+        for (int ch = 0; ch < numLayoutChannels && ch < static_cast<int>(assigned.size()); ++ch)
+        {
+            const auto type = layout.getTypeOfChannel(ch);
+            if (assigned[static_cast<size_t>(ch)] || type == Type::LFE || type == Type::LFE2)
+                continue;
 
-            // L/R独立したコムフィルターを通す
-            float combOutL = 0.0f;
-            float combOutR = 0.0f;
-            for (int i = 0; i < 8; ++i)
+            if (numPairs == maxPairs)
             {
-                combOutL += combFiltersL[i].process(preDelayedL);
-                combOutR += combFiltersR[i].process(preDelayedR);
+                jassertfalse;   // 扱えない数のチャンネル（残りはドライのまま）
+                break;
             }
-            combOutL *= 0.125f;  // 1/8
-            combOutR *= 0.125f;
 
-            // クロスフィード（ステレオイメージを自然にする）
-            float crossFeedAmount = 0.15f;
-            float tempL = combOutL + combOutR * crossFeedAmount;
-            float tempR = combOutR + combOutL * crossFeedAmount;
-            combOutL = tempL;
-            combOutR = tempR;
+            int partner = -1;
+            const auto partnerType = partnerChannelType(type);
+            if (partnerType != Type::unknown)
+                partner = layout.getChannelIndexForType(partnerType);
+            else if (type >= Type::discreteChannel0 && ch + 1 < numLayoutChannels
+                     && layout.getTypeOfChannel(ch + 1) >= Type::discreteChannel0)
+                partner = ch + 1;   // 種類のない配置は隣どうしを組にする
 
-            // L/R独立したオールパスフィルターで拡散
-            for (int i = 0; i < 4; ++i)
-            {
-                combOutL = allPassFiltersL[i].process(combOutL);
-                combOutR = allPassFiltersR[i].process(combOutR);
-            }
+            if (partner >= 0 && assigned[static_cast<size_t>(partner)])
+                partner = -1;
+
+            assigned[static_cast<size_t>(ch)] = true;
+            if (partner >= 0)
+                assigned[static_cast<size_t>(partner)] = true;
+
+            laneChannel[numPairs * 2] = ch;
+            laneChannel[numPairs * 2 + 1] = partner;
+            ++numPairs;
+        }
+
+        // 空の配置（無効なバス）などはステレオとして扱う
+        if (numPairs == 0)
+        {
+            laneChannel[0] = 0;
+            laneChannel[1] = 1;
+            numPairs = 1;
+        }
+    }
 
-            // ローパスフィルター（高域を減衰）
-            float filteredL = lowPassFilterL.processSingleSampleRaw(combOutL);
-            float filteredR = lowPassFilterR.processSingleSampleRaw(combOutR);
+    // ペアごとのカーネルを選ぶ（処理中はこれを見るだけで、チャンネル数では分岐しない）。
+    // モノラル入力として扱うのは出力がステレオのときだけ（ほかの配置は入力と出力が同じ）
+    void selectPairKernels(const juce::AudioChannelSet& inputLayout)
+    {
+        const bool monoInput = inputLayout.size() == 1 && numPairs == 1 && laneChannel[1] >= 0;
+        for (int p = 0; p < numPairs; ++p)
+        {
+            if (laneChannel[p * 2 + 1] < 0)
+                pairKernel[p] = PairKernel::MonoToMono;
+            else if (monoInput)
+                pairKernel[p] = PairKernel::MonoToStereo;
+            else
+                pairKernel[p] = PairKernel::Stereo;
+        }
+    }
 
-            // ローシェルフフィルター（低域強化）
-            filteredL = lowShelfFilterL.processSingleSampleRaw(filteredL);
-            filteredR = lowShelfFilterR.processSingleSampleRaw(filteredR);
+    // R レーンが L レーンと同じ入力を受けるか（モノラルの音源）。
+    // そのレーンはプリEQ・間引きを通さず、L レーンの結果とプリディレイ・初期反射の遅延線を使う
+    bool sharesInput(int lane) const
+    {
+        return (lane & 1) != 0 && pairKernel[lane / 2] != PairKernel::Stereo;
+    }
 
-            // ステレオ幅を適用
-            float mid = (filteredL + filteredR) * 0.5f;
-            float side = (filteredL - filteredR) * 0.5f * stereoWidth;
-            filteredL = mid + side;
-            filteredR = mid - side;
+    // L 側の種類に対応する R 側の種類（組にならない種類は unknown）
+    static juce::AudioChannelSet::ChannelType partnerChannelType(juce::AudioChannelSet::ChannelType type)
+    {
+        using Type = juce::AudioChannelSet::ChannelType;
+        switch (type)
+        {
+            case Type::left:              return Type::right;
+            case Type::leftCentre:        return Type::rightCentre;
+            case Type::leftSurround:      return Type::rightSurround;
+            case Type::leftSurroundSide:  return Type::rightSurroundSide;
+            case Type::leftSurroundRear:  return Type::rightSurroundRear;
+            case Type::wideLeft:          return Type::wideRight;
+            case Type::topFrontLeft:      return Type::topFrontRight;
+            case Type::topSideLeft:       return Type::topSideRight;
+            case Type::topRearLeft:       return Type::topRearRight;
+            default:                      return Type::unknown;
+        }
+    }
 
-            // Wet/Dry ミックス
-            float wetL = filteredL * wetGain;
-            float wetR = filteredR * wetGain;
-            float dryL = inputL * dryGain;
-            float dryR = inputR * dryGain;
+    // ペアごとの遅延時間の倍率（最初のペアは 1.0 = ステレオ時と同じ）
+    static float pairDelayScale(int pair)
+    {
+        return 1.0f + 0.0707f * static_cast<float>(pair);
+    }
 
-            buffer.setSample(0, sample, dryL + wetL);
-            if (numChannels > 1)
-                buffer.setSample(1, sample, dryR + wetR);
+    // プリセットごとの部屋（初期反射の鏡像法に使う）
+    // Arena / Stadium はアリーナの床を囲むスタンドの前面を壁とみなした寸法。野外の Stadium は天井なし
+    static RoomGeometry roomGeometryFor(DomePreset preset)
+    {
+        RoomGeometry room;   // Arena
+        switch (preset)
+        {
+            case DomePreset::Arena:
+                break;
+            case DomePreset::Stadium:
+                room = { 70.0f, 90.0f, 35.0f, 35.0f, 5.0f, 9.0f, 27.0f, 30.0f, 1.7f, 0.65f, 0.4f, 0.0f };
+                break;
+            case DomePreset::Hall:
+                room = { 32.0f, 45.0f, 18.0f, 16.0f, 4.0f, 2.0f, 13.0f, 22.0f, 1.2f, 0.8f, 0.5f, 0.8f };
+                break;
+            case DomePreset::Club:
+                room = { 14.0f, 22.0f, 6.0f, 7.0f, 2.0f, 1.5f, 5.5f, 11.0f, 1.7f, 0.7f, 0.5f, 0.6f };
+                break;
         }
+        return room;
     }
 
-    // バッファをクリア
-    void clear()
+    // 全プリセットの部屋から全レーンの初期反射のタップを設計しておく（偶数レーンが左耳、奇数レーンが右耳）。
+    // 鏡像法は重いので prepare() で済ませ、プリセットの切り替えは表を引くだけにする
+    void designPresetEarlyReflections()
     {
-        for (auto& comb : combFiltersL)
-            comb.clear();
-        for (auto& comb : combFiltersR)
-            comb.clear();
-        for (auto& ap : allPassFiltersL)
-            ap.clear();
-        for (auto& ap : allPassFiltersR)
-            ap.clear();
-        std::fill(preDelayBufferL.begin(), preDelayBufferL.end(), 0.0f);
-        std::fill(preDelayBufferR.begin(), preDelayBufferR.end(), 0.0f);
-        lowPassFilterL.reset();
-        lowPassFilterR.reset();
-        lowShelfFilterL.reset();
-        lowShelfFilterR.reset();
+        for (int preset = 0; preset < DomeFilterTable::numPresets; ++preset)
+        {
+            const RoomGeometry room = roomGeometryFor(static_cast<DomePreset>(preset));
+            for (int lane = 0; lane < numPairs * 2; ++lane)
+                presetEarlyTaps[preset][lane] = earlyReflections[lane].designTaps(room, (lane % 2 == 0) ? -1.0f : 1.0f,
+                                                                                 pairDelayScale(lane / 2));
+        }
     }
 
-private:
-    // ワンノブに基づいてパラメータを更新
-    void updateParameters()
+    // 現在のプリセットの初期反射に切り替える（fadeSamples は内部レートのサンプル数）
+    void applyPresetEarlyReflections(int fadeSamples)
+    {
+        const int preset = static_cast<int>(currentPreset);
+        smoothedEarlyLevel.setTargetValue(presetEarlyLevel[preset]);
+
+        if (! earlyReflections[0].isPrepared())
+            return;   // prepare() で決める
+
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+            earlyReflections[lane].setTaps(presetEarlyTaps[preset][lane], fadeSamples);
+    }
+
+    // ワンノブに基づいてパラメータを更新（制御ブロックごとに呼ばれる軽い処理のみ）
+    void applyDomeAmount(float amount)
     {
         // Wet/Dry ミックス（ノブが上がるほどWetが増える）
-        wetGain = domeAmount * 0.6f;  // 最大60%のWet（控えめに）
-        dryGain = 1.0f - (domeAmount * 0.3f);  // 最低70%のDry
+        wetGain = amount * 0.6f;  // 最大60%のWet（控えめに）
+        dryGain = 1.0f - (amount * 0.3f);  // 最低70%のDry
 
         // プリディレイ（短縮版: 最大30ms、L/Rで少しずらす）
-        preDelaySamplesL = static_cast<int>(domeAmount * 25.0f * sampleRate / 1000.0f);
-        preDelaySamplesR = static_cast<int>(domeAmount * 30.0f * sampleRate / 1000.0f);
-        
-        if (preDelaySamplesL >= static_cast<int>(preDelayBufferL.size()))
-            preDelaySamplesL = static_cast<int>(preDelayBufferL.size()) - 1;
-        if (preDelaySamplesR >= static_cast<int>(preDelayBufferR.size()))
-            preDelaySamplesR = static_cast<int>(preDelayBufferR.size()) - 1;
+        // 変化中は小数サンプルの遅延として補間して読む。リサンプラーの遅延はここから差し引く
+        const float maxPreDelay = static_cast<float>(maxPreDelaySamples);
+        const float resamplerLatency = static_cast<float>(getResamplerLatency()) / static_cast<float>(rateFactor);
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+            preDelay[lane] = std::clamp(amount * preDelayMsAtFullAmount[lane] * static_cast<float>(internalSampleRate) / 1000.0f
+                                            - resamplerLatency,
+                                        0.0f, maxPreDelay);
 
         // フィードバック（ノブが上がるほどRT60が長く）
-        float feedback = 0.75f + domeAmount * 0.12f; // 0.75 - 0.87
-        for (auto& comb : combFiltersL)
-            comb.setFeedback(feedback);
-        for (auto& comb : combFiltersR)
-            comb.setFeedback(feedback);
+        combFeedback = combFeedbackFor(amount);
 
         // ダンピング（ノブが上がるほど高域が減衰）
-        float damping = 0.15f + domeAmount * 0.35f; // 0.15 - 0.5
-        for (auto& comb : combFiltersL)
-            comb.setDamping(damping);
-        for (auto& comb : combFiltersR)
-            comb.setDamping(damping);
-
-        // ローパスカットオフ
-        float cutoff = 10000.0f - domeAmount * 5000.0f; // 10kHz - 5kHz
-        lowPassFilterL.setCoefficients(
-            juce::IIRCoefficients::makeLowPass(sampleRate, cutoff)
-        );
-        lowPassFilterR.setCoefficients(
-            juce::IIRCoefficients::makeLowPass(sampleRate, cutoff)
-        );
-
-        // ローシェルフ（低域ブースト）
-        lowShelfFilterL.setCoefficients(
-            juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7f, bassBoost)
-        );
-        lowShelfFilterR.setCoefficients(
-            juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7f, bassBoost)
-        );
+        combDamping = 0.15f + amount * 0.35f; // 0.15 - 0.5
+
+        withClassicTank([this](auto& tank)
+        {
+            tank.setFeedback(combFeedback);
+            tank.setDamping(combDamping);
+        });
+
+        if (engine == ReverbEngine::Fdn8 || engine == ReverbEngine::Fdn16)
+            updateFdnDecay(amount);
+    }
+
+    // コムのフィードバック（ノブが上がるほどRT60が長く）
+    static float combFeedbackFor(float amount)
+    {
+        return 0.75f + amount * 0.12f; // 0.75 - 0.87
+    }
+
+    // FDN の低域の残響時間（秒）
+    static float fdnDecayTimeAtDC(float amount)
+    {
+        return 1.2f + amount * 1.3f;   // 1.2 - 2.5 秒
+    }
+
+    // FDN の残響時間（コムのフィードバック・ダンピングの範囲に合わせる）
+    void updateFdnDecay(float amount)
+    {
+        const float rt60Low = fdnDecayTimeAtDC(amount);
+        const float rt60High = rt60Low * (0.6f - amount * 0.3f);   // 高域はノブが上がるほど短く
+
+        for (int p = 0; p < numPairs; ++p)
+        {
+            if (engine == ReverbEngine::Fdn8)
+                fdn8[p].setDecayTime(rt60Low, rt60High);
+            else
+                fdn16[p].setDecayTime(rt60Low, rt60High);
+        }
+    }
+
+    // 残響が消えるまでの時間を、現在のエンジン・品質・ノブの目標値・IR から求めて公開する
+    // （ホストはメッセージスレッドから getTailLengthSeconds() を読むので、状態そのものは読ませない）
+    void updateTailLength()
+    {
+        tailLengthSeconds.store(computeTailLengthSeconds(), std::memory_order_relaxed);
+    }
+
+    double computeTailLengthSeconds() const
+    {
+        const float amount = smoothedAmount.getTargetValue();
+        double decaySeconds = 0.0;
+
+        if (engine == ReverbEngine::Convolution && impulseResponse != nullptr)
+        {
+            // IR の長さ（プリディレイは IR に含まれる）
+            decaySeconds = impulseResponse->getLengthInSamples() / impulseResponse->getSampleRate();
+        }
+        else if (engine == ReverbEngine::Fdn8 || engine == ReverbEngine::Fdn16)
+        {
+            decaySeconds = 2.0 * fdnDecayTimeAtDC(amount) + maxPreDelaySeconds + EarlyReflections<SampleType>::maxDelaySeconds;
+        }
+        else
+        {
+            // 一番長いコム（DC でのループゲイン = フィードバック）が 120dB 落ちるまで
+            const double loopSeconds = withClassicTank([](const auto& tank) { return tank.getLongestCombDelayMs(); }) / 1000.0;
+            decaySeconds = 6.0 * loopSeconds / -std::log10(static_cast<double>(combFeedbackFor(amount)))
+                         + maxPreDelaySeconds + EarlyReflections<SampleType>::maxDelaySeconds;
+        }
+
+        return decaySeconds + static_cast<double>(getResamplerLatency()) / sampleRate;
+    }
+
+    // ポストフィルターの目標係数を決める（ノブ・プリセットが変わったときだけ）
+    // 係数は共有の表から引く。ノブが 0.01 刻みから外れた値のときだけローパスをその場で設計する
+    void designPostFilterTargets()
+    {
+        if (filterTable == nullptr)
+            return;   // prepare() で決める
+
+        // ローパス（ノブが上がるほど暗く）
+        const float amount = smoothedAmount.getTargetValue();
+        const int step = DomeFilterTable::amountStep(amount);
+        if (step >= 0)
+        {
+            std::copy(filterTable->lowPass[step], filterTable->lowPass[step] + 5, postFilterTarget[0]);
+        }
+        else
+        {
+            const auto lowPass = DomeFilterTable::designLowPass(internalSampleRate, amount);
+            std::copy(lowPass.coefficients, lowPass.coefficients + 5, postFilterTarget[0]);
+        }
+
+        // ローシェルフ（低域ブースト、プリセットごと）
+        const float* lowShelf = filterTable->lowShelf[static_cast<int>(currentPreset)];
+        std::copy(lowShelf, lowShelf + 5, postFilterTarget[1]);
+        postFilterRampSamples = static_cast<int>(smoothingTimeSeconds * sampleRate);
+    }
+
+    bool isSmoothing() const
+    {
+        return smoothedAmount.isSmoothing() || smoothedWidth.isSmoothing() || smoothedEarlyLevel.isSmoothing()
+            || postFilterRampSamples > 0;
+    }
+
+    // 1制御ブロック分パラメータを進める（前の値はブロック内のランプに使う）
+    void advanceParameters(int numSamples)
+    {
+        previousWetGain = wetGain;
+        previousDryGain = dryGain;
+        std::copy(preDelay, preDelay + maxLanes, previousPreDelay);
+
+        previousEarlyLevel = earlyLevel;
+
+        applyDomeAmount(smoothedAmount.skip(numSamples));
+        stereoWidth = smoothedWidth.skip(numSamples);
+        earlyLevel = smoothedEarlyLevel.skip(numSamples);
+
+        // ポストフィルター係数を目標へ線形補間
+        if (postFilterRampSamples > 0)
+        {
+            const float t = std::min(1.0f, static_cast<float>(numSamples) / static_cast<float>(postFilterRampSamples));
+            for (int f = 0; f < 2; ++f)
+                for (int k = 0; k < 5; ++k)
+                    postFilterCurrent[f][k] += (postFilterTarget[f][k] - postFilterCurrent[f][k]) * t;
+
+            postFilterRampSamples = std::max(0, postFilterRampSamples - numSamples);
+            filters.setSection(lowPassSection, postFilterCurrent[0]);
+            filters.setSection(lowShelfSection, postFilterCurrent[1]);
+        }
+    }
+
+    // 変化がないときはランプなしで処理する
+    void holdParameters()
+    {
+        previousWetGain = wetGain;
+        previousDryGain = dryGain;
+        previousEarlyLevel = earlyLevel;
+        std::copy(preDelay, preDelay + maxLanes, previousPreDelay);
+    }
+
+    // すべてのパラメータを目標値に即座に揃える（prepare() 直後）
+    void snapParametersToTargets()
+    {
+        smoothedAmount.setCurrentAndTargetValue(smoothedAmount.getTargetValue());
+        smoothedWidth.setCurrentAndTargetValue(smoothedWidth.getTargetValue());
+        smoothedEarlyLevel.setCurrentAndTargetValue(smoothedEarlyLevel.getTargetValue());
+        applyDomeAmount(smoothedAmount.getTargetValue());
+        stereoWidth = smoothedWidth.getTargetValue();
+        earlyLevel = smoothedEarlyLevel.getTargetValue();
+        holdParameters();
+
+        std::copy(&postFilterTarget[0][0], &postFilterTarget[0][0] + 10, &postFilterCurrent[0][0]);
+        postFilterRampSamples = 0;
+        filters.setSection(lowPassSection, postFilterCurrent[0]);
+        filters.setSection(lowShelfSection, postFilterCurrent[1]);
+        needsSnap = false;
+    }
+
+    // 入力の無音と後期残響の出力から、wet の経路を止めるかを決める
+    // 入力が来たらすぐ再開する（タンク・遅延線・フィルターは止めたときの -120dB 未満の状態から続ける。
+    // メーターも止めたときのまま触らない）
+    void updateSleepState(SampleType* const* io, int n)
+    {
+        float inputPeak = 0.0f;
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+        {
+            if (io[lane] != nullptr && ! sharesInput(lane))
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(io[lane], n);
+                inputPeak = std::max({ inputPeak, static_cast<float>(-range.getStart()), static_cast<float>(range.getEnd()) });
+            }
+        }
+
+        if (inputPeak >= silenceThreshold)
+        {
+            silentInputSamples = 0;
+            quietTankSamples = 0;
+            sleeping = false;
+            return;
+        }
+
+        if (sleeping)
+            return;
+        silentInputSamples = std::min(silentInputSamples + n, maxCount);
+
+        // タンクの出力はこのチャンクを処理したあとに分かるので、前のチャンクまでの分で判定する
+        // 入力が止まってからプリディレイ・一番長い遅延線・オールパスを一巡しても
+        // 出力が -120dB 未満のままなら、タンクの中にも残っていない
+        // （Convolution は IR の長さが過ぎるまで待つ）
+        int requiredSamples = static_cast<int>(quietWindowSeconds * sampleRate);
+        if (engine == ReverbEngine::Convolution && impulseResponse != nullptr)
+            requiredSamples = std::max(requiredSamples,
+                                       static_cast<int>(impulseResponse->getLengthInSamples()) * rateFactor);
+
+        if (silentInputSamples >= requiredSamples && quietTankSamples >= requiredSamples)
+            sleeping = true;
+    }
+
+    // 止まっている間は dry のゲインを掛けるだけ（ゲイン変化中はランプ）
+    void processDryOnly(SampleType* const* io, int n)
+    {
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+        {
+            SampleType* out = io[lane];
+            if (out == nullptr)
+                continue;
+
+            if (previousDryGain == dryGain)
+            {
+                juce::FloatVectorOperations::multiply(out, static_cast<SampleType>(dryGain), n);
+                continue;
+            }
+
+            const float dryStep = (dryGain - previousDryGain) / static_cast<float>(n);
+            for (int i = 0; i < n; ++i)
+                out[i] *= static_cast<SampleType>(previousDryGain + dryStep * static_cast<float>(i + 1));
+        }
+    }
+
+    // 止めていた状態を解除して、判定をやり直す
+    void wake()
+    {
+        sleeping = false;
+        silentInputSamples = 0;
+        quietTankSamples = 0;
+    }
+
+    // 最大 maxBlockSize サンプルをステージごとに処理
+    // io はレーンごとの入出力（nullptr のレーンは出力を捨てる。入力を共有するレーンの入力は読まない）
+    void processChunk(SampleType* const* io, int n)
+    {
+        const int numLanes = numPairs * 2;
+
+        SampleType* wet[maxLanes] = {};
+        SampleType* temp[maxLanes] = {};
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            wet[lane] = wetBuffer.getWritePointer(lane);
+            temp[lane] = tempBuffer.getWritePointer(lane);
+        }
+
+        // 入力を取得（入力を共有するレーンは L レーンの結果を使うので 0 にしておく）
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            if (io[lane] != nullptr && ! sharesInput(lane))
+                juce::FloatVectorOperations::copy(wet[lane], io[lane], n);
+            else
+                juce::FloatVectorOperations::clear(wet[lane], n);
+        }
+
+        if (rateFactor == 1)
+        {
+            SampleType* const* result = processWet(wet, temp, n);
+
+            // Wet/Dry ミックス（ゲイン変化中はサンプルごとにランプ）
+            StageProfiler::ScopedStage profileMix(StageProfiler::Stage::Mix);
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                if (io[lane] != nullptr)
+                {
+                    wetMeter.add(result[lane], n, wetGain);
+                    mixWetDry(io[lane], result[lane], n);
+                }
+            }
+            return;
+        }
+
+        // 内部レートへ間引き（wet → temp、2段目は temp の中で。入力を共有するレーンは通さない）
+        int m = 0;
+        {
+            StageProfiler::ScopedStage profileResample(StageProfiler::Stage::Resample);
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                if (sharesInput(lane))
+                    continue;
+                m = decimators[lane][0].process(wet[lane], temp[lane], n);
+                if (numResamplerStages == 2)
+                    m = decimators[lane][1].process(temp[lane], temp[lane], m);
+            }
+            for (int lane = 1; lane < numLanes; lane += 2)
+                if (sharesInput(lane))
+                    juce::FloatVectorOperations::clear(temp[lane], m);
+        }
+
+        // 内部レートで wet の経路を処理し、補間して FIFO に足す（出力を捨てる仮想レーンは補間しない）
+        if (m > 0)
+        {
+            SampleType* const* result = processWet(temp, wet, m);
+            SampleType* const* spare = (result == temp) ? wet : temp;
+
+            StageProfiler::ScopedStage profileResample(StageProfiler::Stage::Resample);
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                if (laneChannel[lane] < 0)
+                    continue;
+
+                SampleType* fifo = upsampledFifo[lane].data() + fifoCount;
+                if (numResamplerStages == 2)
+                {
+                    interpolators[lane][1].process(result[lane], spare[lane], m);
+                    interpolators[lane][0].process(spare[lane], fifo, 2 * m);
+                }
+                else
+                {
+                    interpolators[lane][0].process(result[lane], fifo, m);
+                }
+            }
+            fifoCount += m * rateFactor;
+        }
+
+        // FIFO の先頭 n サンプルでミックスし、残り（rateFactor - 1 サンプル以下）を前に詰める
+        jassert(fifoCount >= n);
+        StageProfiler::ScopedStage profileMix(StageProfiler::Stage::Mix);
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            if (laneChannel[lane] < 0)
+                continue;
+
+            SampleType* fifo = upsampledFifo[lane].data();
+            if (io[lane] != nullptr)
+            {
+                wetMeter.add(fifo, n, wetGain);
+                mixWetDry(io[lane], fifo, n);
+            }
+            std::copy(fifo + n, fifo + fifoCount, fifo);
+        }
+        fifoCount -= n;
+    }
+
+    // wet の経路（プリEQ → プリディレイ → 後期残響 → ポストフィルター → 幅）を内部レートで処理
+    // wet が入力、temp は作業領域。結果の入ったほう（wet か temp）を返す
+    SampleType* const* processWet(SampleType* const* wet, SampleType* const* temp, int n)
+    {
+        const int numLanes = numPairs * 2;
+        const bool convolution = engine == ReverbEngine::Convolution && impulseResponse != nullptr;
+        const bool fdn = engine == ReverbEngine::Fdn8 || engine == ReverbEngine::Fdn16;
+
+        // Classic は L/R のレーンに分けて2スレッドで処理できる（クロスフィードの手前まで）
+        // （品質の切り替え直後、前のタンクを鳴らしている間はこのスレッドだけで）
+        if (! convolution && ! fdn && (nonRealtime || n >= parallelMinSamples) && laneWorker.isThreadRunning()
+            && ! isQualityFading())
+            return processClassicLanesInParallel(wet, temp, n);
+
+        // ==========================================================
+        // プリEQを適用（リバーブに送る前のEQカーブ）
+        // ==========================================================
+        {
+            StageProfiler::ScopedStage profileStage(StageProfiler::Stage::PreEq);
+            filters.processBlock(wet, n, preEQFirstSection, numPreEQSections);
+        }
+
+        // 実測 IR の畳み込み（wet → temp）
+        if (convolution)
+        {
+            {
+                StageProfiler::ScopedStage profileStage(StageProfiler::Stage::Convolution);
+                for (int p = 0; p < numPairs; ++p)
+                {
+                    const int l = p * 2;
+                    convolve(p, wet[l], wet[sharesInput(l + 1) ? l : l + 1], temp[l], temp[l + 1], n);
+                }
+            }
+            measureTank(temp, n);
+            return temp;
+        }
+
+        // 初期反射（wet → early）とプリディレイ（wet → temp）はレーン独立 - EQ処理済みの信号を使用
+        // 初期反射は後期残響にも送る（入力を共有するレーンは直前の L レーンが書いた遅延線から読む）
+        SampleType* early[maxLanes] = {};
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            early[lane] = earlyBuffer.getWritePointer(lane);
+            processEarlyAndPreDelay(lane, wet[lane], early[lane], temp[lane], n);
+        }
+
+        // 後期残響（temp → wet）
+        if (fdn)
+        {
+            StageProfiler::ScopedStage profileStage(StageProfiler::Stage::Fdn);
+            for (int p = 0; p < numPairs; ++p)
+            {
+                const int l = p * 2;
+                if (engine == ReverbEngine::Fdn8)
+                    fdn8[p].processBlock(temp[l], temp[l + 1], wet[l], wet[l + 1], n);
+                else
+                    fdn16[p].processBlock(temp[l], temp[l + 1], wet[l], wet[l + 1], n);
+            }
+        }
+        else
+        {
+            processClassicTank(temp, wet, n);
+        }
+        measureTank(wet, n);
+        addEarlyReflections(wet, early, n);
+        return processPostTank(wet, temp, n);
+    }
+
+    // Classic の wet の経路を偶数レーン（L）と奇数レーン（R）に分け、R 側をワーカーで同時に処理する。
+    // プリEQ → 初期反射・プリディレイ → 並列コムはレーンごとに独立（触る状態もレーンごとに別）なので分けられる。
+    // 入力を共有するペアは遅延線も共有するので、コムの手前までを先にこのスレッドで通す。
+    // クロスフィード以降は両方が終わってからこのスレッドで行う
+    SampleType* const* processClassicLanesInParallel(SampleType* const* wet, SampleType* const* temp, int n)
+    {
+        const int numLanes = numPairs * 2;
+
+        SampleType* early[maxLanes] = {};
+        for (int lane = 0; lane < numLanes; ++lane)
+            early[lane] = earlyBuffer.getWritePointer(lane);
+
+        auto processFront = [&](int lane)
+        {
+            if (! sharesInput(lane))
+            {
+                StageProfiler::ScopedStage profileStage(StageProfiler::Stage::PreEq);
+                filters.processChannel(lane, wet[lane], n, preEQFirstSection, numPreEQSections);
+            }
+            processEarlyAndPreDelay(lane, wet[lane], early[lane], temp[lane], n);
+        };
+
+        for (int lane = 1; lane < numLanes; lane += 2)
+        {
+            if (sharesInput(lane))
+            {
+                processFront(lane - 1);
+                processFront(lane);
+            }
+        }
+
+        withClassicTank([&](auto& tank)
+        {
+            auto processLane = [&](int lane)
+            {
+                if (! sharesInput(lane | 1))
+                    processFront(lane);
+                tank.processCombs(lane, temp[lane], wet[lane], n);
+            };
+            laneWorker.runLanes(processLane, numLanes);
+
+            tank.processDiffusion(temp, wet, n);
+        });
+
+        measureTank(wet, n);
+        addEarlyReflections(wet, early, n);
+        return processPostTank(wet, temp, n);
+    }
+
+    // 1レーン分の初期反射（input → early）とプリディレイ（input → tankInput）。初期反射は後期残響にも送る
+    // 入力を共有するレーンは input を読まず、このブロックを先に処理した L レーンの遅延線から読む
+    void processEarlyAndPreDelay(int lane, const SampleType* input, SampleType* early, SampleType* tankInput, int n)
+    {
+        const bool shared = sharesInput(lane);
+        {
+            StageProfiler::ScopedStage profileStage(StageProfiler::Stage::EarlyReflections);
+            if (shared)
+                earlyReflections[lane].processShared(early, n);
+            else
+                earlyReflections[lane].process(input, early, n);
+        }
+
+        StageProfiler::ScopedStage profileStage(StageProfiler::Stage::PreDelay);
+        processPreDelay(shared ? nullptr : input, tankInput, n, preDelayLines[lane], preDelayWriteIndex[lane],
+                        previousPreDelay[lane], preDelay[lane]);
+        juce::FloatVectorOperations::addWithMultiply(tankInput, early, static_cast<SampleType>(earlyToTank), n);
+    }
+
+    // 後期残響の出力に初期反射を足す（ポストフィルター・幅は一緒に通す、レベル変化中はサンプルごとにランプ）
+    void addEarlyReflections(SampleType* const* wet, const SampleType* const* early, int n)
+    {
+        if (previousEarlyLevel == earlyLevel)
+        {
+            for (int lane = 0; lane < numPairs * 2; ++lane)
+                juce::FloatVectorOperations::addWithMultiply(wet[lane], early[lane], static_cast<SampleType>(earlyLevel), n);
+            return;
+        }
+
+        const float step = (earlyLevel - previousEarlyLevel) / static_cast<float>(n);
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+            for (int i = 0; i < n; ++i)
+                wet[lane][i] += early[lane][i] * static_cast<SampleType>(previousEarlyLevel + step * static_cast<float>(i + 1));
+    }
+
+    // 後期残響の後（ポストフィルター → 幅）。wet が入力、temp は作業領域。wet を返す
+    SampleType* const* processPostTank(SampleType* const* wet, SampleType* const* temp, int n)
+    {
+        // ローパスフィルター（高域を減衰）→ ローシェルフフィルター（低域強化）
+        {
+            StageProfiler::ScopedStage profileStage(StageProfiler::Stage::PostFilter);
+            filters.processBlock(wet, n, lowPassSection, 2);
+        }
+
+        // ステレオ幅をペアごとに適用（mid → tempL, side → tempR）
+        StageProfiler::ScopedStage profileStage(StageProfiler::Stage::Width);
+        for (int p = 0; p < numPairs; ++p)
+        {
+            SampleType* wetL = wet[p * 2];
+            SampleType* wetR = wet[p * 2 + 1];
+            SampleType* tempL = temp[p * 2];
+            SampleType* tempR = temp[p * 2 + 1];
+
+            juce::FloatVectorOperations::add(tempL, wetL, wetR, n);
+            juce::FloatVectorOperations::multiply(tempL, SampleType(0.5), n);
+            juce::FloatVectorOperations::subtract(tempR, wetL, wetR, n);
+            juce::FloatVectorOperations::multiply(tempR, static_cast<SampleType>(0.5f * stereoWidth), n);
+            juce::FloatVectorOperations::add(wetL, tempL, tempR, n);
+            if (pairKernel[p] != PairKernel::MonoToMono)   // 仮想の R レーンの出力は捨てる
+                juce::FloatVectorOperations::subtract(wetR, tempL, tempR, n);
+        }
+        return wet;
+    }
+
+    // ペア p の畳み込み。倍精度のときは float に変換して通し、結果を戻す
+    void convolve(int p, const SampleType* inputL, const SampleType* inputR,
+                  SampleType* outputL, SampleType* outputR, int n)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            convolvers[p].process(inputL, inputR, outputL, outputR, n);
+        }
+        else
+        {
+            float* scratch[4];
+            for (int i = 0; i < 4; ++i)
+                scratch[i] = convolutionScratch.getWritePointer(i);
+
+            juce::FloatVectorOperations::convertDoubleToFloat(scratch[0], inputL, n);
+            juce::FloatVectorOperations::convertDoubleToFloat(scratch[1], inputR, n);
+            convolvers[p].process(scratch[0], scratch[1], scratch[2], scratch[3], n);
+            juce::FloatVectorOperations::convertFloatToDouble(outputL, scratch[2], n);
+            juce::FloatVectorOperations::convertFloatToDouble(outputR, scratch[3], n);
+        }
+    }
+
+    // 後期残響の出力を測る（片割れのない仮想レーンは数えない）
+    // 止める判定用に、このチャンクのピークも覚えておく
+    void measureTank(const SampleType* const* tankOutput, int n)
+    {
+        for (int lane = 0; lane < numPairs * 2; ++lane)
+            if (laneChannel[lane] >= 0)
+                chunkTankPeak = std::max(chunkTankPeak, tankMeter.add(tankOutput[lane], n));
+    }
+
+    // リサンプラーの状態と FIFO を空にする
+    void resetResamplers()
+    {
+        for (int lane = 0; lane < maxLanes; ++lane)
+        {
+            for (auto& d : decimators[lane])
+                d.reset();
+            for (auto& i : interpolators[lane])
+                i.reset();
+            std::fill(upsampledFifo[lane].begin(), upsampledFifo[lane].end(), SampleType(0));
+        }
+        fifoCount = rateFactor - 1;
+    }
+
+    // 間引き → 補間による wet の遅延（ホストのサンプル数）
+    // 各段で間引き・補間それぞれ 15 サンプル（その段の入力側のレート）。
+    // FIFO に先に入れる 0 は、間引きの位相（2サンプル目で1出力）と打ち消し合うので遅延にならない
+    int getResamplerLatency() const
+    {
+        return HalfBand::latency * 2 * (rateFactor - 1);
+    }
+
+    // 並列コム → クロスフィード → オールパス（input は作業領域として上書きされる）
+    // 品質を切り替えた直後は、前の品質のタンクを無入力で回してフェードしながら足す
+    void processClassicTank(SampleType* const* input, SampleType* const* output, int n)
+    {
+        withClassicTank([&](auto& tank) { tank.process(input, output, n); });
+        if (! isQualityFading())
+            return;
+
+        const int numLanes = numPairs * 2;
+        const float step = 1.0f / static_cast<float>(qualityFadeSeconds * internalSampleRate);
+
+        // 戻ってきたタンク（フェードアウトの途中だったもの）は残っていた音のレベルから 1 へ
+        auto& currentGain = qualityGain[static_cast<size_t>(quality)];
+        if (currentGain < 1.0f)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+                for (int i = 0; i < n; ++i)
+                    output[lane][i] *= static_cast<SampleType>(std::min(1.0f, currentGain + step * static_cast<float>(i + 1)));
+            currentGain = std::min(1.0f, currentGain + step * static_cast<float>(n));
+        }
+
+        SampleType* silence[maxLanes] = {};
+        SampleType* fadeOutput[maxLanes] = {};
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            silence[lane] = qualityFadeBuffer.getWritePointer(lane);
+            fadeOutput[lane] = qualityFadeBuffer.getWritePointer(numLanes + lane);
+        }
+
+        for (int q = 0; q < numQualities; ++q)
+        {
+            auto& gain = qualityGain[static_cast<size_t>(q)];
+            if (q == static_cast<int>(quality) || gain == 0.0f)
+                continue;
+
+            // 入力は止める（作業領域として上書きされるので毎回 0 にする）
+            for (int lane = 0; lane < numLanes; ++lane)
+                juce::FloatVectorOperations::clear(silence[lane], n);
+            withClassicTank(static_cast<ReverbQuality>(q), [&](auto& tank) { tank.process(silence, fadeOutput, n); });
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                for (int i = 0; i < n; ++i)
+                    output[lane][i] += fadeOutput[lane][i]
+                                     * static_cast<SampleType>(std::max(0.0f, gain - step * static_cast<float>(i + 1)));
+            gain = std::max(0.0f, gain - step * static_cast<float>(n));
+        }
+    }
+
+    // 前の品質のタンクをフェードアウト中か（現在のタンクが 1 へ戻る途中も含む）
+    bool isQualityFading() const
+    {
+        for (int q = 0; q < numQualities; ++q)
+            if (qualityGain[static_cast<size_t>(q)] != (q == static_cast<int>(quality) ? 1.0f : 0.0f))
+                return true;
+        return false;
+    }
+
+    // フェードをやめ、現在の品質のタンクだけを鳴らす（ほかのタンクは次に切り替えたときに空にする）
+    void resetQualityFade()
+    {
+        qualityGain.fill(0.0f);
+        qualityGain[static_cast<size_t>(quality)] = 1.0f;
+    }
+
+    // 現在の品質のタンクで fn(tank) を呼ぶ
+    template <typename Function>
+    decltype(auto) withClassicTank(Function&& fn)
+    {
+        return withClassicTank(quality, std::forward<Function>(fn));
+    }
+
+    template <typename Function>
+    decltype(auto) withClassicTank(Function&& fn) const
+    {
+        switch (quality)
+        {
+            case ReverbQuality::Eco:   return fn(ecoTank);
+            case ReverbQuality::High:  return fn(highTank);
+            default:                   return fn(standardTank);
+        }
+    }
+
+    // 品質 q のタンクで fn(tank) を呼ぶ
+    template <typename Function>
+    decltype(auto) withClassicTank(ReverbQuality q, Function&& fn)
+    {
+        switch (q)
+        {
+            case ReverbQuality::Eco:   return fn(ecoTank);
+            case ReverbQuality::High:  return fn(highTank);
+            default:                   return fn(standardTank);
+        }
+    }
+
+    // out = out * dryGain + wet * wetGain
+    void mixWetDry(SampleType* out, const SampleType* wet, int n)
+    {
+        if (previousDryGain == dryGain && previousWetGain == wetGain)
+        {
+            juce::FloatVectorOperations::multiply(out, static_cast<SampleType>(dryGain), n);
+            juce::FloatVectorOperations::addWithMultiply(out, wet, static_cast<SampleType>(wetGain), n);
+            return;
+        }
+
+        const float dryStep = (dryGain - previousDryGain) / static_cast<float>(n);
+        const float wetStep = (wetGain - previousWetGain) / static_cast<float>(n);
+        for (int i = 0; i < n; ++i)
+        {
+            const float g = static_cast<float>(i + 1);
+            out[i] = out[i] * static_cast<SampleType>(previousDryGain + dryStep * g)
+                   + wet[i] * static_cast<SampleType>(previousWetGain + wetStep * g);
+        }
+    }
+
+    void clearPreDelay(int lane)
+    {
+        if (preDelayLines[lane] != nullptr)   // prepare() 前
+            std::fill(preDelayLines[lane], preDelayLines[lane] + preDelayMask + 1, SampleType(0));
     }
 
     // プリディレイ処理（L/R独立）
-    float processPreDelay(float input, std::vector<float>& buffer, int& writeIndex, int delaySamples)
+    // ブロックをまとめてリングバッファに書き込んでから、遅延分さかのぼって読み出す。
+    // どちらも最大2つの連続区間に分けてコピーするだけで済む
+    // 遅延時間が変化中（startDelay != endDelay）は小数遅延を線形補間で読む
+    // input が nullptr なら書き込まない（同じリングバッファに L レーンが書いた後で読むだけ）
+    void processPreDelay(const SampleType* input, SampleType* output, int numSamples,
+                         SampleType* data, int& writeIndex,
+                         float startDelay, float endDelay)
     {
-        if (delaySamples == 0)
-            return input;
+        const int mask = preDelayMask;
+        const int size = mask + 1;
 
-        int readIndex = writeIndex - delaySamples;
-        if (readIndex < 0)
-            readIndex += static_cast<int>(buffer.size());
+        if (input != nullptr)
+        {
+            const int firstWrite = std::min(numSamples, size - writeIndex);
+            std::copy(input, input + firstWrite, data + writeIndex);
+            std::copy(input + firstWrite, input + numSamples, data);
+        }
 
-        float delayed = buffer[readIndex];
-        buffer[writeIndex] = input;
+        if (startDelay != endDelay)
+        {
+            const float step = (endDelay - startDelay) / static_cast<float>(numSamples);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float readPos = static_cast<float>(writeIndex + i) - (startDelay + step * static_cast<float>(i + 1));
+                if (readPos < 0.0f)
+                    readPos += static_cast<float>(size);
+
+                int index0 = static_cast<int>(readPos);
+                const auto frac = static_cast<SampleType>(readPos - static_cast<float>(index0));
+                if (index0 >= size)
+                    index0 -= size;
+                const int index1 = index0 + 1 >= size ? index0 + 1 - size : index0 + 1;
+
+                output[i] = data[index0] + frac * (data[index1] - data[index0]);
+            }
+        }
+        else
+        {
+            const int readIndex = (writeIndex - static_cast<int>(endDelay)) & mask;
 
-        writeIndex++;
-        if (writeIndex >= static_cast<int>(buffer.size()))
-            writeIndex = 0;
+            const int firstRead = std::min(numSamples, size - readIndex);
+            std::copy(data + readIndex, data + readIndex + firstRead, output);
+            std::copy(data, data + (numSamples - firstRead), output + firstRead);
+        }
 
-        return delayed;
+        writeIndex = (writeIndex + numSamples) & mask;
     }
 
     double sampleRate = 44100.0;
-    float domeAmount = 0.5f;
-    float stereoWidth = 0.8f;
-    float bassBoost = 1.5f;
+    int maxBlockSize = 512;
+
+    // wet の経路の内部レート（sampleRate / rateFactor）
+    double maxInternalSampleRate = 48000.0;
+    double internalSampleRate = 44100.0;
+    int rateFactor = 1;
+    int maxInternalBlockSize = 512;
     DomePreset currentPreset = DomePreset::Arena;
 
-    // エフェクトパラメータ
+    // パラメータのスムージング（50ms、制御ブロック 32 サンプルごとに更新）
+    static constexpr int controlBlockSize = 32;
+    static constexpr double smoothingTimeSeconds = 0.05;
+    juce::SmoothedValue<float> smoothedAmount { 0.5f };
+    juce::SmoothedValue<float> smoothedWidth { 0.8f };
+    bool needsSnap = true;
+
+    // エフェクトパラメータ（現在の制御ブロックの値と1つ前の値）
+    float stereoWidth = 0.8f;
+    float combFeedback = 0.82f;
+    float combDamping = 0.3f;
     float wetGain = 0.3f;
     float dryGain = 0.85f;
+    float previousWetGain = 0.3f;
+    float previousDryGain = 0.85f;
+
+    // ポストフィルター係数 [ローパス, ローシェルフ][b0, b1, b2, a1, a2]
+    std::shared_ptr<const DomeFilterTable::Table> filterTable;   // 内部レートの係数表（全インスタンスで共有）
+    float postFilterCurrent[2][5] = {};
+    float postFilterTarget[2][5] = {};
+    int postFilterRampSamples = 0;
+
+    // チャンネル配置（レーン 2p, 2p+1 がペア p の L/R、-1 は片割れのない仮想レーン）
+    int numPairs = 1;
+    int laneChannel[maxLanes] = { 0, 1 };
+    PairKernel pairKernel[maxPairs] = { PairKernel::Stereo };
+
+    // DSPコンポーネント（レーン独立）
+    ReverbEngine engine = ReverbEngine::Classic;
+    ReverbQuality quality = ReverbQuality::Standard;
+    ClassicTank<SampleType, 4, 2> ecoTank;         // コム 4 / オールパス 2（レーンごと）
+    ClassicTank<SampleType, 8, 4> standardTank;    // コム 8 / オールパス 4
+    ClassicTank<SampleType, 16, 6> highTank;       // コム 16 / オールパス 6
+
+    // qualityGain は品質ごとのタンクの出力ゲイン（0 のタンクは鳴っておらず、次に使うときに空にする）
+    static constexpr int numQualities = 3;
+    std::array<float, numQualities> qualityGain { 0.0f, 1.0f, 0.0f };
+    juce::AudioBuffer<SampleType> qualityFadeBuffer;   // 無入力（作業領域）と出力、各 numLanes チャンネル
+    std::array<FdnTank<SampleType, 8>, maxPairs> fdn8;
+    std::array<FdnTank<SampleType, 16>, maxPairs> fdn16;
+
+    // 畳み込み（ペアごと）とテール区間のワーカー（ワーカーが先に破棄されるよう後ろに置く）
+    std::shared_ptr<const ConvolutionIR> impulseResponse;
+    std::array<PartitionedConvolver, maxPairs> convolvers;
+    ConvolutionWorker convolutionWorker;
+    LaneWorker laneWorker;   // L/R のレーン分割で R 側を処理する
+    juce::AudioBuffer<float> convolutionScratch;   // 倍精度のときだけ使う
+    bool nonRealtime = false;
+    bool parallelLanes = true;
+
+    // プリディレイ（レーン独立）
+    SampleType* preDelayLines[maxLanes] = {};   // DelaySlab の中
+    int preDelayMask = 0;                       // 長さ - 1（長さは2の累乗）
+    int preDelayWriteIndex[maxLanes] = {};
+    float preDelayMsAtFullAmount[maxLanes] = {};
+    float preDelay[maxLanes] = {};           // 遅延時間（サンプル）
+    float previousPreDelay[maxLanes] = {};
+    int maxPreDelaySamples = 0;
+
+    // 初期反射（レーン独立）。後期残響の出力に earlyLevel、後期残響の入力に earlyToTank を掛けて足す
+    static constexpr float presetEarlyLevel[4] = { 0.2f, 0.15f, 0.2f, 0.2f };   // Arena, Stadium, Hall, Club
+    static constexpr float earlyToTank = 0.1f;
+    std::array<EarlyReflections<SampleType>, maxLanes> earlyReflections;
+    typename EarlyReflections<SampleType>::Taps presetEarlyTaps[DomeFilterTable::numPresets][maxLanes];   // prepare() で設計
+    juce::SmoothedValue<float> smoothedEarlyLevel { presetEarlyLevel[0] };
+    float earlyLevel = presetEarlyLevel[0];
+    float previousEarlyLevel = presetEarlyLevel[0];
+
+    // 遅延線のメモリ（タンク・FDN・プリディレイ・初期反射）と、prepare() で数えた内訳
+    DelaySlab<SampleType> delaySlab;
+    MemoryReport memoryReport;
+
+    // ステージ間の作業バッファ（prepare() で maxBlockSize 分を確保）
+    juce::AudioBuffer<SampleType> wetBuffer;
+    juce::AudioBuffer<SampleType> tempBuffer;
+    juce::AudioBuffer<SampleType> earlyBuffer;
+
+    // 内部レートとの変換（レーンごと、[0] がホスト側の段）
+    int numResamplerStages = 0;
+    std::array<std::array<HalfBandDecimator<SampleType>, 2>, maxLanes> decimators;
+    std::array<std::array<HalfBandInterpolator<SampleType>, 2>, maxLanes> interpolators;
+    std::array<std::vector<SampleType>, maxLanes> upsampledFifo;
+    int fifoCount = 0;
+
+    // getTailLengthSeconds() の値（パラメータを変えたスレッドが書き、ホストが読む）
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
+    // メーター用の測定値（process() の中で足し込み、resetMeters() で 0 に戻す）
+    LevelMeter::Accumulator wetMeter;
+    LevelMeter::Accumulator tankMeter;
+
+    // 無音のときに wet の経路を止める
+    // 入力が止まってから、プリディレイ（50ms）・一番長い遅延線（FDN 16 の 7.1.4 最後のペアで約 190ms）・
+    // オールパスを一巡する時間
+    static constexpr float silenceThreshold = 1.0e-6f;    // -120dB
+    static constexpr double quietWindowSeconds = 0.3;
+    static constexpr double maxPreDelaySeconds = 0.05;
+    static constexpr int maxCount = 1 << 30;
+    bool sleeping = false;
+    int silentInputSamples = 0;    // 入力が無音になってからのサンプル数（ホストのレート）
+    int quietTankSamples = 0;      // 後期残響の出力が -120dB 未満のままのサンプル数
+    float chunkTankPeak = 0.0f;
 
-    // DSPコンポーネント（L/R独立）
-    std::array<CombFilter, 8> combFiltersL;
-    std::array<CombFilter, 8> combFiltersR;
-    std::array<AllPassFilter, 4> allPassFiltersL;
-    std::array<AllPassFilter, 4> allPassFiltersR;
-
-    // プリディレイ（L/R独立）
-    std::vector<float> preDelayBufferL;
-    std::vector<float> preDelayBufferR;
-    int preDelayWriteIndexL = 0;
-    int preDelayWriteIndexR = 0;
-    int preDelaySamplesL = 0;
-    int preDelaySamplesR = 0;
-
-    // フィルター（L/R独立）
-    juce::IIRFilter lowPassFilterL;
-    juce::IIRFilter lowPassFilterR;
-    juce::IIRFilter lowShelfFilterL;
-    juce::IIRFilter lowShelfFilterR;
-
-    // プリEQフィルター（リバーブ前のEQカーブ）- FL Studio画像に基づく
-    juce::IIRFilter preEQ_Band1L;   // 50Hz ローシェルフ +1dB
-    juce::IIRFilter preEQ_Band1R;
-    juce::IIRFilter preEQ_Band2L;   // 100Hz ピーク -1dB
-    juce::IIRFilter preEQ_Band2R;
-    juce::IIRFilter preEQ_Band3L;   // 200Hz ピーク -3dB
-    juce::IIRFilter preEQ_Band3R;
-    juce::IIRFilter preEQ_Band4L;   // 400Hz ピーク -4dB
-    juce::IIRFilter preEQ_Band4R;
-    juce::IIRFilter preEQ_Band5L;   // 1kHz ピーク +2dB
-    juce::IIRFilter preEQ_Band5R;
-    juce::IIRFilter preEQ_Band6L;   // 4kHz ピーク +6dB
-    juce::IIRFilter preEQ_Band6R;
-    juce::IIRFilter preEQ_Band7L;   // 10kHz ローパス
-    juce::IIRFilter preEQ_Band7R;
+    // フィルター（プリEQ 7バンド + ローパス + ローシェルフ、全レーンをまとめて処理）
+    // プリEQ は FL Studio画像に基づく:
+    //   50Hz ローシェルフ +1dB / 100Hz ピーク -1dB / 200Hz ピーク -3dB / 400Hz ピーク -4dB /
+    //   1kHz ピーク +2dB / 4kHz ピーク +6dB / 10kHz ローパス
+    static constexpr int preEQFirstSection = 0;
+    static constexpr int numPreEQSections = DomeFilterTable::numPreEQBands;
+    static constexpr int lowPassSection = 7;
+    static constexpr int lowShelfSection = 8;
+    MultichannelBiquadCascade<SampleType, 9> filters;
 };
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    EarlyReflections.cpp
+    初期反射の実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "EarlyReflections.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+    EarlyReflections.h
+    初期反射 - 鏡像法（直方体の部屋）で求めた疎なタップを1本の遅延線から読むマルチタップディレイ
+
+    部屋の寸法・音源（ステージのスピーカー）・聴取位置から、壁・床・天井で
+    maxOrder 回までの反射の鏡像音源を並べ、直接音から maxDelaySeconds 以内に届くものを
+    強い順に maxTaps 本まで残す。L/R は耳の位置（聴取位置から左右に earOffset）で
+    到達時間がずれ、横から来る反射ほど遠い側の耳で小さくなる。
+    ゲインは直接音との距離の比（1/r）と反射率の積で、タップ全体のエネルギーを 1 にそろえる。
+
+    処理はブロックをまとめて遅延線に書き込んでから、タップごとにブロック長の連続区間を
+    読んで足し込む（1タップ = ベクトル化された積和1〜2回）。遅延線は DelaySlab から切り出し、
+    長さは2の累乗で、読み出し位置の折り返しはマスクで済ませる。
+    同じ入力を受ける L/R（モノラルの音源）は、R 側が L 側の遅延線を共有してタップだけを読む。
+    タップの設計（designTaps()、鏡像を数千個調べる）はオーディオスレッドの外で前もって行い、
+    切り替えは setTaps() で（メモリを確保しないので、プリセット変更と同じくオーディオスレッドから呼んでよい）。
+    フェードを指定すると、その間だけ古いタップの組も読んで線形にクロスフェードする。
+    フェード中に次の組が来たら、今のフェードが終わってからその組へフェードする（待つのは最新の1組だけ）。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "DelaySlab.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+// 直方体の部屋（メートル、原点は部屋の隅: x = 幅, y = 奥行き（ステージ側が 0）, z = 高さ）
+struct RoomGeometry
+{
+    float width = 50.0f, length = 60.0f, height = 28.0f;
+    float sourceX = 25.0f, sourceY = 4.0f, sourceZ = 7.0f;
+    float listenerX = 19.0f, listenerY = 24.0f, listenerZ = 1.7f;
+    float wallReflection = 0.75f;      // 側壁・前後の壁の反射率
+    float floorReflection = 0.4f;      // 床（客席）の反射率
+    float ceilingReflection = 0.8f;    // 天井の反射率（野外は 0）
+};
+
+template <typename SampleType>
+class EarlyReflections
+{
+public:
+    static constexpr int maxTaps = 32;
+    static constexpr int maxOrder = 3;
+    static constexpr double maxDelaySeconds = 0.12;
+    static constexpr float speedOfSound = 343.0f;
+    static constexpr float earOffset = 0.09f;   // 聴取位置から耳までの距離（メートル）
+
+    // タップの組（遅延の短い順）
+    struct Taps
+    {
+        int numTaps = 0;
+        int delays[maxTaps] = {};
+        SampleType gains[maxTaps] = {};
+    };
+
+    EarlyReflections() = default;
+    ~EarlyReflections() = default;
+
+    // 最大の遅延（delayScale を掛けたもの）と1ブロック分が入る長さの遅延線を slab から切り出す
+    // （slab.layout() の中から呼ぶ）
+    void prepare(double newSampleRate, int maxBlockSize, DelaySlab<SampleType>& slab, float maxDelayScale = 1.0f)
+    {
+        sampleRate = newSampleRate;
+        const int required = static_cast<int>(std::ceil(maxDelaySeconds * maxDelayScale * sampleRate)) + maxBlockSize + 1;
+        const int size = DelaySlab<SampleType>::powerOfTwoLength(required);
+        line = slab.allocate(size);
+        mask = size - 1;
+        writeIndex = 0;
+        blockSize = std::max(1, maxBlockSize);
+        fadeBuffer.assign(static_cast<size_t>(blockSize), SampleType(0));
+        taps = {};
+        fadeRemaining = 0;
+        hasPendingTaps = false;
+    }
+
+    // 遅延線を owner と共有する（同じ入力を受ける L/R 用、owner の prepare() の後に呼ぶ）。
+    // 書き込みは owner の process() が行うので、こちらは processShared() で読むだけ
+    void prepareShared(const EarlyReflections& owner)
+    {
+        sampleRate = owner.sampleRate;
+        line = owner.line;
+        mask = owner.mask;
+        writeIndex = 0;
+        blockSize = owner.blockSize;
+        fadeBuffer.assign(static_cast<size_t>(blockSize), SampleType(0));
+        taps = {};
+        fadeRemaining = 0;
+        hasPendingTaps = false;
+    }
+
+    // 部屋と耳からタップを設計して、すぐに使う
+    void design(const RoomGeometry& room, float side, float delayScale = 1.0f)
+    {
+        setTaps(designTaps(room, side, delayScale));
+    }
+
+    // 部屋と耳（side: -1 = 左, +1 = 右）からタップを設計する（prepare() の後、状態は変えない）。
+    // delayScale はペアごとに遅延を伸ばして、チャンネル間の相関をなくすための倍率。
+    // 鏡像を数千個調べるので、オーディオスレッドからは呼ばないこと
+    Taps designTaps(const RoomGeometry& room, float side, float delayScale = 1.0f) const
+    {
+        const float earX = room.listenerX + side * earOffset;
+        const float direct = distance(room.sourceX - earX, room.sourceY - room.listenerY,
+                                      room.sourceZ - room.listenerZ);
+        const float maxExtra = static_cast<float>(maxDelaySeconds) * speedOfSound;
+        const int maxDelaySamples = mask + 1 - blockSize;   // 読む区間がこのブロックの書き込みに重ならない長さ
+
+        // 強い順に maxTaps 本（挿入ソート、メモリは確保しない）
+        float tapGain[maxTaps];
+        int tapDelay[maxTaps];
+        int count = 0;
+
+        // 各軸の鏡像: position = (1 - 2u) * source + 2 n L、手前の壁で |n - u| 回・奥の壁で |n| 回反射
+        for (int nx = -maxOrder; nx <= maxOrder; ++nx)
+        for (int ux = 0; ux < 2; ++ux)
+        {
+            const int hitsX = std::abs(nx - ux) + std::abs(nx);
+            if (hitsX > maxOrder) continue;
+            const float x = (1 - 2 * ux) * room.sourceX + 2.0f * nx * room.width;
+
+            for (int ny = -maxOrder; ny <= maxOrder; ++ny)
+            for (int uy = 0; uy < 2; ++uy)
+            {
+                const int hitsY = std::abs(ny - uy) + std::abs(ny);
+                if (hitsX + hitsY > maxOrder) continue;
+                const float y = (1 - 2 * uy) * room.sourceY + 2.0f * ny * room.length;
+
+                for (int nz = -maxOrder; nz <= maxOrder; ++nz)
+                for (int uz = 0; uz < 2; ++uz)
+                {
+                    const int floorHits = std::abs(nz - uz);
+                    const int ceilingHits = std::abs(nz);
+                    const int order = hitsX + hitsY + floorHits + ceilingHits;
+                    if (order == 0 || order > maxOrder) continue;   // 直接音は dry が担う
+
+                    const float z = (1 - 2 * uz) * room.sourceZ + 2.0f * nz * room.height;
+                    const float dx = x - earX;
+                    const float dy = y - room.listenerY;
+                    const float d = distance(dx, dy, z - room.listenerZ);
+                    if (d - direct > maxExtra) continue;
+
+                    // 横から来るほど遠い側の耳で小さく（頭の陰）
+                    const float lateral = dx / std::max(1.0e-3f, std::sqrt(dx * dx + dy * dy));
+                    float gain = direct / d * (1.0f + 0.3f * side * lateral)
+                               * std::pow(room.wallReflection, static_cast<float>(hitsX + hitsY))
+                               * std::pow(room.floorReflection, static_cast<float>(floorHits))
+                               * std::pow(room.ceilingReflection, static_cast<float>(ceilingHits));
+                    if (gain <= 0.0f) continue;
+
+                    const int delay = std::clamp(static_cast<int>(std::lround((d - direct) * delayScale / speedOfSound * sampleRate)),
+                                                 1, maxDelaySamples);
+                    insertTap(tapGain, tapDelay, count, gain, delay);
+                }
+            }
+        }
+
+        // タップ全体のエネルギーを 1 に
+        float energy = 0.0f;
+        for (int t = 0; t < count; ++t)
+            energy += tapGain[t] * tapGain[t];
+        const float normalise = energy > 0.0f ? 1.0f / std::sqrt(energy) : 0.0f;
+
+        // 遅延の短い順に並べて持つ（読み出しが遅延線を前から順に進む）
+        int order[maxTaps];
+        for (int t = 0; t < count; ++t)
+            order[t] = t;
+        std::sort(order, order + count, [&](int a, int b) { return tapDelay[a] < tapDelay[b]; });
+
+        Taps result;
+        for (int t = 0; t < count; ++t)
+        {
+            result.delays[t] = tapDelay[order[t]];
+            result.gains[t] = static_cast<SampleType>(tapGain[order[t]] * normalise);
+        }
+        result.numTaps = count;
+        return result;
+    }
+
+    // タップを切り替える（メモリを確保しないので、オーディオスレッドから呼んでよい）。
+    // fadeSamples > 0 ならその間、古いタップの組も読んでクロスフェードする。
+    // フェード中に次が来たら、途中の混ざり具合を捨てて飛ばないよう、今のフェードが終わるまで待たせる
+    // （待っている組は新しいもので置き換える）。fadeSamples = 0 ならフェードをやめてすぐに切り替える
+    void setTaps(const Taps& newTaps, int fadeSamples = 0)
+    {
+        if (fadeSamples > 0 && fadeRemaining > 0)
+        {
+            pendingTaps = newTaps;
+            pendingFadeLength = fadeSamples;
+            hasPendingTaps = true;
+            return;
+        }
+
+        previousTaps = taps;
+        taps = newTaps;
+        fadeLength = std::max(0, fadeSamples);
+        fadeRemaining = fadeLength;
+        hasPendingTaps = false;
+    }
+
+    bool isPrepared() const { return line != nullptr; }
+    bool isFading() const { return fadeRemaining > 0 || hasPendingTaps; }
+    int getNumTaps() const { return taps.numTaps; }
+    int getTapDelay(int index) const { return taps.delays[index]; }
+    SampleType getTapGain(int index) const { return taps.gains[index]; }
+
+    // 入力をブロックごと遅延線に書き込み、全タップの和を output に書く
+    // （numSamples は prepare() の maxBlockSize 以下、input と output は別の領域）
+    void process(const SampleType* input, SampleType* output, int numSamples)
+    {
+        SampleType* data = line;
+        const int size = mask + 1;
+
+        const int firstWrite = std::min(numSamples, size - writeIndex);
+        std::copy(input, input + firstWrite, data + writeIndex);
+        std::copy(input + firstWrite, input + numSamples, data);
+
+        processShared(output, numSamples);
+    }
+
+    // 遅延線に書かずに全タップの和を output に書き、書き込み位置を進める（process() の後半）。
+    // prepareShared() したほうは、owner がこのブロックを process() した後にこれだけを呼ぶ
+    void processShared(SampleType* output, int numSamples)
+    {
+        readTaps(taps, output, numSamples);
+
+        // フェード中は古いタップの組も読み、新しいほうへ線形に移る
+        if (fadeRemaining > 0)
+        {
+            SampleType* previous = fadeBuffer.data();
+            readTaps(previousTaps, previous, numSamples);
+
+            const int count = std::min(numSamples, fadeRemaining);
+            const auto step = SampleType(1) / static_cast<SampleType>(fadeLength);
+            const int done = fadeLength - fadeRemaining;
+            for (int i = 0; i < count; ++i)
+            {
+                const auto g = static_cast<SampleType>(done + i + 1) * step;
+                output[i] = previous[i] + g * (output[i] - previous[i]);
+            }
+            fadeRemaining -= count;
+
+            // 待っていた組へは次のブロックからフェードする
+            if (fadeRemaining == 0 && hasPendingTaps)
+                setTaps(pendingTaps, pendingFadeLength);
+        }
+
+        writeIndex = (writeIndex + numSamples) & mask;
+    }
+
+    // 遅延線をクリア（タップはそのまま、prepare() 前は何もしない。共有している遅延線なら owner の分も）
+    void clear()
+    {
+        if (line != nullptr)
+            std::fill(line, line + mask + 1, SampleType(0));
+    }
+
+private:
+    // タップの組の和を output に書く（書き込み位置は進めない）
+    void readTaps(const Taps& set, SampleType* output, int numSamples) const
+    {
+        const SampleType* data = line;
+        const int size = mask + 1;
+
+        juce::FloatVectorOperations::clear(output, numSamples);
+        for (int t = 0; t < set.numTaps; ++t)
+        {
+            const int readIndex = (writeIndex - set.delays[t]) & mask;
+            const int firstRead = std::min(numSamples, size - readIndex);
+            juce::FloatVectorOperations::addWithMultiply(output, data + readIndex, set.gains[t], firstRead);
+            if (firstRead < numSamples)
+                juce::FloatVectorOperations::addWithMultiply(output + firstRead, data, set.gains[t], numSamples - firstRead);
+        }
+    }
+
+    static float distance(float dx, float dy, float dz)
+    {
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    static void insertTap(float* tapGain, int* tapDelay, int& count, float gain, int delay)
+    {
+        if (count == maxTaps && gain <= tapGain[maxTaps - 1])
+            return;
+
+        int t = count < maxTaps ? count++ : maxTaps - 1;
+        while (t > 0 && tapGain[t - 1] < gain)
+        {
+            tapGain[t] = tapGain[t - 1];
+            tapDelay[t] = tapDelay[t - 1];
+            --t;
+        }
+        tapGain[t] = gain;
+        tapDelay[t] = delay;
+    }
+
+    double sampleRate = 44100.0;
+    SampleType* line = nullptr;   // DelaySlab の中
+    int mask = 0;
+    int writeIndex = 0;
+    int blockSize = 1;
+
+    Taps taps;
+    Taps previousTaps;                   // フェード中だけ読む、切り替え前のタップの組
+    int fadeLength = 0;
+    int fadeRemaining = 0;
+    Taps pendingTaps;                    // フェード中に来た次の組（フェードが終わったら切り替える）
+    int pendingFadeLength = 0;
+    bool hasPendingTaps = false;
+    std::vector<SampleType> fadeBuffer;  // 古いタップの組の和（blockSize）
+};
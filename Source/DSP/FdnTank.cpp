@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    FdnTank.cpp
+    FDN 後期残響タンクの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "FdnTank.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
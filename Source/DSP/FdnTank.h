@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+    FdnTank.h
+    FDN（フィードバック・ディレイ・ネットワーク）後期残響タンク
+
+    NumLines 本（8 / 16）の遅延線の出力をアダマール行列で混ぜて全ての線に戻す。
+    行列の掛け算は高速ウォルシュ・アダマール変換（O(N log N)、加減算のみ）で行う。
+    並列コムと違い各線の出力が毎周回ほかの全ての線に広がるため、
+    少ない演算でエコー密度が急速に上がり、オールパスによる拡散が要らない。
+
+    各線には RT60 の目標値（低域・高域）から求めた1次の吸収フィルターを入れ、
+    どの線も同じ速さで減衰するようにする（Jot の方法）。
+    SampleType は float / double（遅延線・状態・演算の型）。
+    遅延線は DelaySlab から切り出し（遅延 + 1 を2の累乗に切り上げた長さ、折り返しはマスク）。
+  ==============================================================================
+*/
+
+#pragma once
+#include "DelaySlab.h"
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+template <typename SampleType, int NumLines>
+class FdnTank
+{
+public:
+    static_assert(NumLines == 8 || NumLines == 16, "FdnTank supports 8 or 16 lines");
+    static constexpr int numLines = NumLines;
+
+    FdnTank() = default;
+    ~FdnTank() = default;
+
+    // サンプルレートで遅延線を slab から切り出して初期化（slab.layout() の中から呼ぶ）
+    // delayScale で全ての線の長さを伸ばす（多チャンネル時にペアごとの相関をなくす）
+    void prepare(double newSampleRate, DelaySlab<SampleType>& slab, float delayScale = 1.0f)
+    {
+        sampleRate = newSampleRate;
+
+        for (int line = 0; line < NumLines; ++line)
+        {
+            // 遅延長は互いに素になるよう素数サンプルに丸める（固有モードの重なりを避ける）
+            const int length = nextPrime(static_cast<int>(delayTimesMs()[line] * delayScale * sampleRate / 1000.0));
+
+            const int size = DelaySlab<SampleType>::powerOfTwoLength(length + 1);
+            lines[line] = slab.allocate(size);
+            lineMask[line] = size - 1;
+            delaySamples[line] = length;
+            writeIndex[line] = 0;
+            readIndex[line] = size - length;
+            filterStore[line] = SampleType(0);
+        }
+
+        setDecayTime(rt60Low, rt60High);
+    }
+
+    // 残響時間（-60dB までの秒数）を低域（DC）と高域（ナイキスト）で設定
+    void setDecayTime(float rt60AtDC, float rt60AtNyquist)
+    {
+        rt60Low = std::max(0.05f, rt60AtDC);
+        rt60High = std::clamp(rt60AtNyquist, 0.05f, rt60Low);
+
+        for (int line = 0; line < NumLines; ++line)
+        {
+            // 遅延 d サンプルで 60dB 減衰するための1周回あたりのゲイン
+            const double seconds = delaySamples[line] / sampleRate;
+            const auto gainLow = static_cast<SampleType>(std::pow(10.0, -3.0 * seconds / rt60Low));
+            const auto gainHigh = static_cast<SampleType>(std::pow(10.0, -3.0 * seconds / rt60High));
+
+            // 1次ローパス y = b0 x + a1 y[-1] の DC ゲイン = gainLow、ナイキストゲイン = gainHigh
+            a1[line] = (gainLow - gainHigh) / (gainLow + gainHigh);
+            b0[line] = SampleType(2) * gainLow * gainHigh / (gainLow + gainHigh);
+        }
+    }
+
+    // ブロック処理（L/R入力 → L/R出力）
+    // 偶数番目の線に L、奇数番目の線に R を入れ、同じ組から取り出す
+    void processBlock(const SampleType* inputL, const SampleType* inputR,
+                      SampleType* outputL, SampleType* outputR, int numSamples)
+    {
+        // 入力を 1/sqrt(N/2) で揃える（8本でも16本でも Classic と同程度の音量になる）
+        const SampleType inputGain = SampleType(1) / std::sqrt(static_cast<SampleType>(NumLines / 2));
+        constexpr SampleType outputGain = SampleType(1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            alignas(32) SampleType x[NumLines];
+
+            // 遅延線の出力を取得して吸収フィルターを通す
+            for (int line = 0; line < NumLines; ++line)
+                x[line] = lines[line][readIndex[line]];
+
+            for (int line = 0; line < NumLines; ++line)
+            {
+                filterStore[line] = b0[line] * x[line] + a1[line] * filterStore[line];
+                x[line] = filterStore[line];
+            }
+
+            // 出力（混ぜる前の各線の出力を L/R に振り分ける）
+            SampleType sumL = SampleType(0);
+            SampleType sumR = SampleType(0);
+            for (int line = 0; line < NumLines; line += 2)
+            {
+                sumL += x[line];
+                sumR += x[line + 1];
+            }
+            outputL[i] = sumL * outputGain;
+            outputR[i] = sumR * outputGain;
+
+            // フィードバック行列（正規化アダマール = 直交行列なのでエネルギーを保存する）
+            fastHadamard(x);
+
+            // 入力を足して書き込み
+            const SampleType inL = inputL[i] * inputGain;
+            const SampleType inR = inputR[i] * inputGain;
+            for (int line = 0; line < NumLines; line += 2)
+            {
+                x[line] += inL;
+                x[line + 1] += inR;
+            }
+
+            for (int line = 0; line < NumLines; ++line)
+                lines[line][writeIndex[line]] = x[line];
+
+            // 読み書き位置を進める（マスクで折り返し）
+            for (int line = 0; line < NumLines; ++line)
+            {
+                readIndex[line] = (readIndex[line] + 1) & lineMask[line];
+                writeIndex[line] = (writeIndex[line] + 1) & lineMask[line];
+            }
+        }
+    }
+
+    // バッファをクリア
+    void clear()
+    {
+        for (int line = 0; line < NumLines; ++line)
+            if (lines[line] != nullptr)   // prepare() 前
+                std::fill(lines[line], lines[line] + lineMask[line] + 1, SampleType(0));
+        std::fill(std::begin(filterStore), std::end(filterStore), SampleType(0));
+    }
+
+private:
+    // 各線の遅延時間（ミリ秒）。8本版は16本版の1本おき
+    static const float* delayTimesMs()
+    {
+        static const float times16[16] = {
+            43.1f, 47.9f, 53.3f, 59.9f, 64.7f, 71.3f, 76.1f, 83.9f,
+            89.3f, 97.1f, 103.7f, 109.9f, 118.3f, 126.1f, 133.9f, 142.7f
+        };
+        static const float times8[8] = {
+            43.1f, 53.3f, 64.7f, 76.1f, 89.3f, 103.7f, 118.3f, 133.9f
+        };
+        return NumLines == 16 ? times16 : times8;
+    }
+
+    static int nextPrime(int n)
+    {
+        n = std::max(n, 2);
+        for (;; ++n)
+        {
+            bool prime = true;
+            for (int d = 2; d * d <= n; ++d)
+            {
+                if (n % d == 0)
+                {
+                    prime = false;
+                    break;
+                }
+            }
+            if (prime)
+                return n;
+        }
+    }
+
+    // 高速ウォルシュ・アダマール変換（in-place、1/sqrt(N) で正規化）
+    static void fastHadamard(SampleType* x)
+    {
+        for (int half = 1; half < NumLines; half *= 2)
+        {
+            for (int start = 0; start < NumLines; start += half * 2)
+            {
+                for (int j = start; j < start + half; ++j)
+                {
+                    const SampleType a = x[j];
+                    const SampleType b = x[j + half];
+                    x[j] = a + b;
+                    x[j + half] = a - b;
+                }
+            }
+        }
+
+        const SampleType scale = SampleType(1) / std::sqrt(static_cast<SampleType>(NumLines));
+        for (int line = 0; line < NumLines; ++line)
+            x[line] *= scale;
+    }
+
+    double sampleRate = 44100.0;
+    float rt60Low = 2.0f;
+    float rt60High = 1.0f;
+
+    // 線ごとの状態（SoA）
+    SampleType* lines[NumLines] = {};            // DelaySlab の中
+    alignas(32) int lineMask[NumLines] = {};     // 長さ - 1（長さは2の累乗）
+    alignas(32) int delaySamples[NumLines] = {};
+    alignas(32) int readIndex[NumLines] = {};
+    alignas(32) int writeIndex[NumLines] = {};
+    alignas(32) SampleType b0[NumLines] = {};
+    alignas(32) SampleType a1[NumLines] = {};
+    alignas(32) SampleType filterStore[NumLines] = {};
+};
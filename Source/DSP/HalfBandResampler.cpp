@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    HalfBandResampler.cpp
+    ハーフバンドリサンプラーの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "HalfBandResampler.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+    HalfBandResampler.h
+    ハーフバンド FIR による 2:1 のダウンサンプリング / 1:2 のアップサンプリング
+
+    96 / 192kHz のセッションでリバーブタンクを 48kHz 前後で動かすためのもの。
+    31 タップのハーフバンドフィルター（カイザー窓、阻止域 約 -80dB）は
+    中央以外の偶数番目の係数が 0 なので、ポリフェーズに分けると
+    1出力（ダウン）/ 1入力（アップ）あたり対称な 8 組の積和だけで済む。
+    通過域は出力レートの 1/3 まで（48kHz で 16kHz）。リバーブの wet は
+    プリEQ とローパスで 10kHz 以下に絞っているので、それより上は要らない。
+
+    どちらも1段あたりの遅延は 15 サンプル（高いほうのレート）。
+    SampleType は float / double（係数は float の表を変換して使う）。
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+namespace HalfBand
+{
+    static constexpr int numTaps = 31;
+    static constexpr int centre = numTaps / 2;          // 15
+    static constexpr int numPairs = (centre + 1) / 2;   // 0 でない対称な係数の組 = 8
+    static constexpr int latency = centre;              // 高いほうのレートでのサンプル数
+
+    // 0 でない係数（中央から奇数だけ離れたタップ）の片側: coefficient(i) はタップ 2i と 30 - 2i
+    // 合計が 0.5 になるよう正規化する（中央 0.5 と合わせて DC ゲイン 1）
+    inline const std::array<float, numPairs>& coefficients()
+    {
+        static const std::array<float, numPairs> table = []
+        {
+            // 0次の第1種変形ベッセル関数（カイザー窓用）
+            auto besselI0 = [](double x)
+            {
+                double sum = 1.0, term = 1.0;
+                for (int k = 1; k < 32; ++k)
+                {
+                    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                    sum += term;
+                }
+                return sum;
+            };
+
+            constexpr double beta = 7.857;   // 阻止域 80dB
+            const double pi = 3.14159265358979323846;
+
+            std::array<double, numPairs> h {};
+            double total = 0.0;
+            for (int i = 0; i < numPairs; ++i)
+            {
+                const int n = 2 * i - centre;   // 中央からの距離（奇数）
+                const double r = static_cast<double>(n) / centre;
+                const double window = besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+                h[static_cast<size_t>(i)] = std::sin(pi * n / 2.0) / (pi * n) * window;
+                total += 2.0 * h[static_cast<size_t>(i)];
+            }
+
+            std::array<float, numPairs> result {};
+            for (int i = 0; i < numPairs; ++i)
+                result[static_cast<size_t>(i)] = static_cast<float>(h[static_cast<size_t>(i)] * 0.5 / total);
+            return result;
+        }();
+        return table;
+    }
+}
+
+//==============================================================================
+// 2:1 ダウンサンプリング（1チャンネル）
+// 入力を「係数が掛かる位相」A と「中央のタップだけの位相」B に振り分け、
+// y[k] = 0.5 B[k-7] + Σ c_i (A[k-i] + A[k-15+i]) を出力の並びに沿って計算する
+template <typename SampleType>
+class HalfBandDecimator
+{
+public:
+    void reset()
+    {
+        phaseA.fill(SampleType(0));
+        phaseB.fill(SampleType(0));
+        pending = SampleType(0);
+        hasPending = false;
+    }
+
+    // numInput サンプルを入れて、できた出力（約半分）の数を返す
+    // 奇数個ずつ入れても、2サンプルごとに1出力の位相は呼び出しをまたいで続く（input と output は同じでもよい）
+    int process(const SampleType* input, SampleType* output, int numInput)
+    {
+        const auto& c = HalfBand::coefficients();
+        constexpr int historyA = HalfBand::centre;       // 15
+        constexpr int historyB = HalfBand::centre / 2;   // 7
+
+        int numOutput = 0;
+        int i = 0;
+        while (i < numInput)
+        {
+            // このチャンクの入力を2つの位相に振り分ける（前の呼び出しの余り1サンプルから）
+            int count = 0;
+            if (hasPending)
+            {
+                phaseB[historyB] = pending;
+                phaseA[historyA] = input[i++];
+                hasPending = false;
+                count = 1;
+            }
+
+            const int pairs = std::min((numInput - i) / 2, chunkSize - count);
+            for (int p = 0; p < pairs; ++p)
+            {
+                phaseB[static_cast<size_t>(historyB + count + p)] = input[i + 2 * p];
+                phaseA[static_cast<size_t>(historyA + count + p)] = input[i + 2 * p + 1];
+            }
+            i += pairs * 2;
+            count += pairs;
+
+            if (i == numInput - 1 && count < chunkSize)
+            {
+                pending = input[i++];
+                hasPending = true;
+            }
+
+            // 出力（チャンクの中で連続したループ）
+            SampleType* y = output + numOutput;
+            for (int k = 0; k < count; ++k)
+                y[k] = SampleType(0.5) * phaseB[static_cast<size_t>(k)];
+            for (int t = 0; t < HalfBand::numPairs; ++t)
+            {
+                const auto ct = static_cast<SampleType>(c[static_cast<size_t>(t)]);
+                const SampleType* newer = phaseA.data() + historyA - t;
+                const SampleType* older = phaseA.data() + t;
+                for (int k = 0; k < count; ++k)
+                    y[k] += ct * (newer[k] + older[k]);
+            }
+            numOutput += count;
+
+            // 履歴を前に詰める
+            std::copy(phaseA.begin() + count, phaseA.begin() + count + historyA, phaseA.begin());
+            std::copy(phaseB.begin() + count, phaseB.begin() + count + historyB, phaseB.begin());
+        }
+        return numOutput;
+    }
+
+private:
+    static constexpr int chunkSize = 64;
+    std::array<SampleType, HalfBand::centre + chunkSize> phaseA {};
+    std::array<SampleType, HalfBand::centre / 2 + chunkSize> phaseB {};
+    SampleType pending = SampleType(0);
+    bool hasPending = false;
+};
+
+//==============================================================================
+// 1:2 アップサンプリング（1チャンネル）
+// 0 を挟んで 2 倍にしたものをフィルターに通すと、偶数番目の出力は 0 でない係数すべて、
+// 奇数番目は中央のタップだけが掛かる: y[2k] = 2 Σ c_i (u[k-i] + u[k-15+i])、y[2k+1] = u[k-7]
+template <typename SampleType>
+class HalfBandInterpolator
+{
+public:
+    void reset()
+    {
+        history.fill(SampleType(0));
+    }
+
+    // numInput サンプルを入れて、2 * numInput サンプルを出力
+    void process(const SampleType* input, SampleType* output, int numInput)
+    {
+        const auto& c = HalfBand::coefficients();
+        constexpr int historySize = HalfBand::centre;   // 15
+
+        while (numInput > 0)
+        {
+            const int count = std::min(numInput, chunkSize);
+            std::copy(input, input + count, history.begin() + historySize);
+
+            SampleType even[chunkSize] = {};
+            for (int t = 0; t < HalfBand::numPairs; ++t)
+            {
+                const auto ct = SampleType(2) * static_cast<SampleType>(c[static_cast<size_t>(t)]);
+                const SampleType* newer = history.data() + historySize - t;
+                const SampleType* older = history.data() + t;
+                for (int k = 0; k < count; ++k)
+                    even[k] += ct * (newer[k] + older[k]);
+            }
+
+            const SampleType* centreTap = history.data() + historySize - HalfBand::centre / 2;
+            for (int k = 0; k < count; ++k)
+            {
+                output[2 * k] = even[k];
+                output[2 * k + 1] = centreTap[k];
+            }
+
+            std::copy(history.begin() + count, history.begin() + count + historySize, history.begin());
+            input += count;
+            output += 2 * count;
+            numInput -= count;
+        }
+    }
+
+private:
+    static constexpr int chunkSize = 64;
+    std::array<SampleType, HalfBand::centre + chunkSize> history {};
+};
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    LaneWorker.cpp
+    L/R のレーンを2つのスレッドで分けて処理するためのワーカースレッド
+  ==============================================================================
+*/
+
+#include "LaneWorker.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+    LaneWorker.h
+    L/R のレーンを2つのスレッドで分けて処理するためのワーカースレッド
+
+    runLanes(fn, numLanes) は偶数レーンを呼び出したスレッドで、奇数レーンをジョブとしてワーカーに渡し、
+    全レーンが終わるのを待つ（2スレッドのバリア）。奇数レーンは1レーンずつジョブ番号を
+    CAS で取る（PartitionedConvolver のジョブ番号と同じく、取ったほうだけが処理する）ので、
+    呼び出し側は自分の分が終わったら、ワーカーがまだ取っていないレーンを取り返して自分で処理する。
+    呼び出し側はロックもスリープも yield（システムコール）もしない。待つのはワーカーが処理中の
+    1レーン分だけで、その間は CPU の pause ヒントを入れてスピンする（処理中のレーンは状態を
+    途中まで進めているので、取り返して最初からやり直すことはできない）。ワーカーは優先度 high で
+    コアが2つ以上あるときだけ動かすので、待つ時間はおおむね1レーン分の処理時間で抑えられる。
+    ワーカーは最後のジョブから idleSpinMs（ブロックの周期よりずっと短い数十µs）だけ pause で
+    次のジョブを待ち、それを過ぎると wait() で眠って 1ms ごとに確認する。
+    オーディオスレッドからは起こさないので、眠っている間に来たレーンは呼び出し側が取り返して処理する
+    （インスタンスが多くても、待っているワーカーがコアを占有し続けない）。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "StageProfiler.h"
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64))
+ #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+#endif
+
+class LaneWorker : public juce::Thread
+{
+public:
+    LaneWorker() : juce::Thread("DomeLive Lanes") {}
+    ~LaneWorker() override { stopThread(1000); }
+
+    // fn(lane) を lane = 0 .. numLanes - 1 について呼ぶ。偶数レーンは呼び出したスレッドで、
+    // 奇数レーンはワーカーと取り合って処理する（スレッドが止まっていれば全部ここで）
+    template <typename Function>
+    void runLanes(Function& fn, int numLanes)
+    {
+        const int numJobs = numLanes / 2;
+        jassert(numJobs < jobMask);
+
+        if (! isThreadRunning() || numJobs == 0)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+                fn(lane);
+            return;
+        }
+
+        context = &fn;
+        invoke = [](void* c, int lane) { (*static_cast<Function*>(c))(lane); };
+        finishedJobs.store(0, std::memory_order_relaxed);
+        jobs.store(static_cast<std::uint32_t>(numJobs) << jobBits, std::memory_order_release);
+
+        for (int lane = 0; lane < numLanes; lane += 2)
+            fn(lane);
+
+        // ワーカーがまだ取っていない奇数レーンを取り返す
+        int job;
+        while ((job = claimJob()) >= 0)
+        {
+            fn(job * 2 + 1);
+            finishedJobs.fetch_add(1, std::memory_order_release);
+        }
+
+        // ワーカーが処理中のレーンを待つ（yield はしない）
+        while (finishedJobs.load(std::memory_order_acquire) != numJobs)
+            pause();
+    }
+
+    void run() override
+    {
+        juce::ScopedNoDenormals noDenormals;   // 呼び出し側の DomeReverb::process() と同じく FTZ / DAZ
+        double lastJobMs = 0.0;
+        while (! threadShouldExit())
+        {
+            int job = claimJob();
+            if (job >= 0)
+            {
+                StageProfiler::ScopedStage profileJob(StageProfiler::Stage::LaneJob);
+                do
+                {
+                    invoke(context, job * 2 + 1);
+                    finishedJobs.fetch_add(1, std::memory_order_release);
+                }
+                while ((job = claimJob()) >= 0);
+
+                lastJobMs = juce::Time::getMillisecondCounterHiRes();
+                continue;
+            }
+
+            if (juce::Time::getMillisecondCounterHiRes() - lastJobMs < idleSpinMs)
+                pause();
+            else
+                wait(1);
+        }
+    }
+
+private:
+    // jobs は（ジョブ数 << jobBits）|（次に取るジョブ番号）。全部取られたら次の runLanes() まで変わらない
+    static constexpr int jobBits = 16;
+    static constexpr std::uint32_t jobMask = (1u << jobBits) - 1;
+    static constexpr double idleSpinMs = 0.05;
+
+    // スピン待ちのヒント（x86 は pause、ARM は yield 命令。どちらもシステムコールではない）
+    static void pause() noexcept
+    {
+       #if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+       #elif defined(_MSC_VER) && defined(_M_ARM64)
+        __yield();
+       #elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    // まだ誰も取っていないジョブを1つ取る（なければ -1）。取ったジョブの処理が終わるまで
+    // runLanes() は戻らないので、CAS に成功した時点の context / invoke はそのジョブのもの
+    int claimJob()
+    {
+        std::uint32_t current = jobs.load(std::memory_order_acquire);
+        while ((current & jobMask) < (current >> jobBits))
+        {
+            if (jobs.compare_exchange_weak(current, current + 1, std::memory_order_acquire))
+                return static_cast<int>(current & jobMask);
+        }
+        return -1;
+    }
+
+    std::atomic<std::uint32_t> jobs { 0 };
+    std::atomic<int> finishedJobs { 0 };
+    void* context = nullptr;
+    void (*invoke)(void*, int) = nullptr;
+};
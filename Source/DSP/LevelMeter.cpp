@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    LevelMeter.cpp
+    レベルメーター用の測定値・FIFO の実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+    LevelMeter.h
+    レベルメーター用の測定値と、オーディオスレッド → UI の受け渡し
+
+    オーディオスレッドはブロックごとに入力・wet・出力のピーク / RMS と
+    タンク（後期残響の出力）のエネルギーを測り、Frame にして FrameFifo に入れる。
+    エディターはタイマー（30Hz）で FrameFifo から取り出して表示する。
+
+    FrameFifo は単一プロデューサー・単一コンシューマーのロックフリー FIFO
+    （juce::AbstractFifo の読み書き位置 + 固定長の配列）。入れる側は確保もロックもしない。
+    UI が止まっていて満杯のときは、測定値を捨てずに次のブロックへ持ち越して合算する。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+namespace LevelMeter
+{
+    // ピーク（絶対値の最大）と RMS、どちらもリニア
+    struct Level
+    {
+        float peak = 0.0f;
+        float rms = 0.0f;
+    };
+
+    // 1回分の測定値（1ブロック、FIFO が満杯だったときは複数ブロックの合算）
+    struct Frame
+    {
+        Level input;
+        Level wet;              // Wet/Dry ミックスで足される wet（wetGain 込み）
+        Level output;
+        float tankEnergy = 0.0f;  // 後期残響（タンク / 畳み込み）の出力の二乗平均
+    };
+
+    //==========================================================================
+    // 信号を足し込んでピークと二乗和を数える（複数チャンネルはまとめて1つの値にする）
+    class Accumulator
+    {
+    public:
+        // 足したデータのピーク（gain を掛ける前）を返す。data は float / double
+        template <typename SampleType>
+        float add(const SampleType* data, int numSamples, float gain = 1.0f) noexcept
+        {
+            if (numSamples <= 0)
+                return 0.0f;
+
+            const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+            const auto dataPeak = static_cast<float>(std::max(-range.getStart(), range.getEnd()));
+            peak = std::max(peak, dataPeak * std::abs(gain));
+
+            SampleType sum = 0;
+            for (int i = 0; i < numSamples; ++i)
+                sum += data[i] * data[i];
+            sumSquares += static_cast<double>(sum) * gain * gain;
+            count += numSamples;
+            return dataPeak;
+        }
+
+        float getPeak() const noexcept { return peak; }
+        float getMeanSquare() const noexcept { return count > 0 ? static_cast<float>(sumSquares / count) : 0.0f; }
+        Level getLevel() const noexcept { return { peak, std::sqrt(getMeanSquare()) }; }
+
+        void reset() noexcept
+        {
+            peak = 0.0f;
+            sumSquares = 0.0;
+            count = 0;
+        }
+
+    private:
+        float peak = 0.0f;
+        double sumSquares = 0.0;
+        int count = 0;
+    };
+
+    //==========================================================================
+    // オーディオスレッド（push）→ メッセージスレッド（pop）の FIFO
+    class FrameFifo
+    {
+    public:
+        static constexpr int capacity = 256;
+
+        // 入れられなかったら false（呼び出し側は測定値を持ち越す）
+        bool push(const Frame& frame) noexcept
+        {
+            const auto scope = fifo.write(1);
+            if (scope.blockSize1 > 0)
+                frames[static_cast<size_t>(scope.startIndex1)] = frame;
+            else if (scope.blockSize2 > 0)
+                frames[static_cast<size_t>(scope.startIndex2)] = frame;
+            else
+                return false;
+            return true;
+        }
+
+        bool isFull() const noexcept { return fifo.getFreeSpace() == 0; }
+
+        // たまっている Frame を古い順に最大 maxFrames 個取り出し、その数を返す
+        int pop(Frame* destination, int maxFrames) noexcept
+        {
+            const auto scope = fifo.read(std::min(maxFrames, fifo.getNumReady()));
+            for (int i = 0; i < scope.blockSize1; ++i)
+                destination[i] = frames[static_cast<size_t>(scope.startIndex1 + i)];
+            for (int i = 0; i < scope.blockSize2; ++i)
+                destination[scope.blockSize1 + i] = frames[static_cast<size_t>(scope.startIndex2 + i)];
+            return scope.blockSize1 + scope.blockSize2;
+        }
+
+    private:
+        juce::AbstractFifo fifo { capacity };
+        std::array<Frame, capacity> frames {};
+    };
+}
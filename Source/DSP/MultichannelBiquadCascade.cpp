@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    MultichannelBiquadCascade.cpp
+    多チャンネル双二次フィルターカスケードの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "MultichannelBiquadCascade.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
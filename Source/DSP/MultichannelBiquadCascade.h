@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+    MultichannelBiquadCascade.h
+    多チャンネル双二次フィルターカスケード - 全チャンネルを SIMD レーンに詰めて処理
+
+    全セクションの係数と状態を [セクション][係数][レーン] の順に1つのオブジェクトへ
+    連続して並べ、最大 maxChannels レーンを転置直接形IIで同時に進める。ブロックの先頭でチャンネルを
+    [サンプル][レーン] の順に並べ替え（インターリーブ）、全セクションを
+    その上で処理してから元に戻す。レーン数は laneGroup の倍数に切り上げるので、
+    8 / 12 チャンネルなら SSE / AVX のレジスタがちょうど埋まる。
+    SampleType は float / double（状態・演算の型。係数は float で設計したものを変換して持つ）。
+    デノーマル対策は呼び出し側の juce::ScopedNoDenormals（FTZ / DAZ）に任せる。ブロック末尾で
+    状態を 0 に丸めると、同じ信号でもブロックの分け方で出力が変わってしまうため。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+#include <algorithm>
+
+template <typename SampleType, int NumSections>
+class MultichannelBiquadCascade
+{
+public:
+    static constexpr int numSections = NumSections;
+    static constexpr int maxChannels = 16;
+    static constexpr int laneGroup = 4;   // SSE 1レジスタ分
+
+    MultichannelBiquadCascade() { reset(); }
+    ~MultichannelBiquadCascade() = default;
+
+    // チャンネル数と最大ブロックサイズでインターリーブ用の作業領域を確保
+    void prepare(int newNumChannels, int maxBlockSize)
+    {
+        jassert(newNumChannels > 0 && newNumChannels <= maxChannels);
+
+        numChannels = std::clamp(newNumChannels, 1, maxChannels);
+        numLanes = numChannels <= 2 ? 2 : (numChannels + laneGroup - 1) / laneGroup * laneGroup;
+        interleaved.assign(static_cast<size_t>(std::max(1, maxBlockSize) * numLanes), SampleType(0));
+        reset();
+    }
+
+    // セクションの係数を設定（全チャンネル共通）
+    void setSection(int index, const juce::IIRCoefficients& c)
+    {
+        setSection(index, c.coefficients);
+    }
+
+    // 正規化済み係数 { b0, b1, b2, a1, a2 } で設定（係数補間用）
+    void setSection(int index, const float* c)
+    {
+        jassert(juce::isPositiveAndBelow(index, NumSections));
+
+        for (int k = 0; k < 5; ++k)
+            std::fill(coefficients[index][k], coefficients[index][k] + maxChannels, static_cast<SampleType>(c[k]));
+    }
+
+    // セクション [firstSection, firstSection + count) を順に通す（in-place）
+    // channels は prepare() で指定した数のチャンネルポインタ
+    void processBlock(SampleType* const* channels, int numSamples,
+                      int firstSection = 0, int count = NumSections)
+    {
+        jassert(firstSection >= 0 && firstSection + count <= NumSections);
+        jassert(numSamples * numLanes <= static_cast<int>(interleaved.size()));
+
+        const int lanes = numLanes;
+        SampleType* data = interleaved.data();
+
+        // [チャンネル][サンプル] → [サンプル][レーン]（余りのレーンは 0 のまま）
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const SampleType* src = channels[ch];
+            for (int i = 0; i < numSamples; ++i)
+                data[i * lanes + ch] = src[i];
+        }
+
+        // レーン数をコンパイル時定数にして、内側のループを固定長のベクトル演算にする
+        switch (numLanes)
+        {
+            case 2:  processSections<2>(data, numSamples, firstSection, count); break;
+            case 4:  processSections<4>(data, numSamples, firstSection, count); break;
+            case 8:  processSections<8>(data, numSamples, firstSection, count); break;
+            case 12: processSections<12>(data, numSamples, firstSection, count); break;
+            default: processSections<16>(data, numSamples, firstSection, count); break;
+        }
+
+        // [サンプル][レーン] → [チャンネル][サンプル]
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            SampleType* dst = channels[ch];
+            for (int i = 0; i < numSamples; ++i)
+                dst[i] = data[i * lanes + ch];
+        }
+    }
+
+    // 1チャンネルだけセクション [firstSection, firstSection + count) に通す（in-place、インターリーブしない）
+    // 触るのはそのチャンネルの状態だけなので、別々のチャンネルなら別のスレッドから同時に呼んでよい
+    void processChannel(int channel, SampleType* data, int numSamples,
+                        int firstSection = 0, int count = NumSections)
+    {
+        jassert(juce::isPositiveAndBelow(channel, numChannels));
+        jassert(firstSection >= 0 && firstSection + count <= NumSections);
+
+        for (int s = firstSection; s < firstSection + count; ++s)
+        {
+            const SampleType b0 = coefficients[s][0][channel];
+            const SampleType b1 = coefficients[s][1][channel];
+            const SampleType b2 = coefficients[s][2][channel];
+            const SampleType a1 = coefficients[s][3][channel];
+            const SampleType a2 = coefficients[s][4][channel];
+            SampleType z1 = state[s][0][channel];
+            SampleType z2 = state[s][1][channel];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const SampleType in = data[i];
+                const SampleType out = b0 * in + z1;
+                z1 = b1 * in - a1 * out + z2;
+                z2 = b2 * in - a2 * out;
+                data[i] = out;
+            }
+
+            state[s][0][channel] = z1;
+            state[s][1][channel] = z2;
+        }
+    }
+
+    // 状態をクリア
+    void reset()
+    {
+        std::fill(&state[0][0][0], &state[0][0][0] + NumSections * 2 * maxChannels, SampleType(0));
+    }
+
+    int getNumChannels() const { return numChannels; }
+
+private:
+    // インターリーブ済みのデータにセクションを順に適用
+    template <int Lanes>
+    void processSections(SampleType* data, int numSamples, int firstSection, int count)
+    {
+        for (int s = firstSection; s < firstSection + count; ++s)
+        {
+            alignas(32) SampleType b0[maxChannels], b1[maxChannels], b2[maxChannels];
+            alignas(32) SampleType a1[maxChannels], a2[maxChannels];
+            alignas(32) SampleType z1[maxChannels], z2[maxChannels];
+
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                b0[lane] = coefficients[s][0][lane];
+                b1[lane] = coefficients[s][1][lane];
+                b2[lane] = coefficients[s][2][lane];
+                a1[lane] = coefficients[s][3][lane];
+                a2[lane] = coefficients[s][4][lane];
+                z1[lane] = state[s][0][lane];
+                z2[lane] = state[s][1][lane];
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                SampleType* x = data + i * Lanes;
+
+                // 転置直接形II: y = b0 x + z1, z1 = b1 x - a1 y + z2, z2 = b2 x - a2 y
+                for (int lane = 0; lane < Lanes; ++lane)
+                {
+                    const SampleType in = x[lane];
+                    const SampleType out = b0[lane] * in + z1[lane];
+                    z1[lane] = b1[lane] * in - a1[lane] * out + z2[lane];
+                    z2[lane] = b2[lane] * in - a2[lane] * out;
+                    x[lane] = out;
+                }
+            }
+
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                state[s][0][lane] = z1[lane];
+                state[s][1][lane] = z2[lane];
+            }
+        }
+    }
+
+    int numChannels = 2;
+    int numLanes = laneGroup;   // numChannels を laneGroup の倍数に切り上げたもの
+
+    // [セクション][b0, b1, b2, a1, a2][レーン]
+    alignas(32) SampleType coefficients[NumSections][5][maxChannels] = {};
+
+    // [セクション][z1, z2][レーン]
+    alignas(32) SampleType state[NumSections][2][maxChannels] = {};
+
+    // インターリーブした作業領域 [サンプル][レーン]
+    std::vector<SampleType> interleaved;
+};
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    PartitionedConvolver.cpp
+    分割畳み込みの実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
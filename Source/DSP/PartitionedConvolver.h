@@ -0,0 +1,649 @@
+/*
+  ==============================================================================
+    PartitionedConvolver.h
+    非一様分割畳み込み - 実測インパルス応答（数秒、ステレオ / トゥルーステレオ）用
+
+    IR を長さの違う3つの区間に分けて畳み込む:
+      [0, B)      先頭 B タップは時間領域で直接畳み込む（レイテンシ 0）
+      [B, 2T)     B サンプルごとの一様分割 FFT 畳み込み（オーディオスレッド）
+      [2T, 末尾)  T サンプルごとの一様分割 FFT 畳み込み（ワーカースレッド）
+    B = 64、T = 1024（48kHz 基準、サンプルレートに合わせて 2 のべき乗で伸ばす）。
+
+    テール区間の結果は入力ブロックを受け取ってから2ブロック後に使うので、
+    ワーカーには丸々1ブロック分（T サンプル）の計算時間がある。
+    受け渡しはジョブ番号の atomic だけで行い、オーディオスレッドはロックも待機もしない。
+    ワーカーが間に合わなかったブロックはテールなしで出力する（getNumUnderruns で数えられる）。
+    オフラインレンダリング時は同期モードにして、テールもその場で計算する。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+//==============================================================================
+// 分割・FFT 済みのインパルス応答（作成後は読み取り専用、複数の畳み込みで共有する）
+class ConvolutionIR
+{
+public:
+    static constexpr int headBlockSize = 64;
+    static constexpr double maxLengthSeconds = 10.0;
+
+    // 入力チャンネル → 出力チャンネルの経路と、使うフィルター（IR のチャンネル）
+    struct Path
+    {
+        int input;
+        int output;
+        int filter;
+    };
+
+    // impulseResponse のチャンネル数で経路を決める:
+    //   1ch = モノラル（L→L, R→R に同じ IR）
+    //   2ch = ステレオ（L→L, R→R）
+    //   4ch = トゥルーステレオ（LL, LR, RL, RR の順）
+    //   それ以外は先頭2チャンネルをステレオとして使う
+    // sampleRate と違うレートの IR はリサンプリングし、最も大きい出力のエネルギーが 1 になるよう正規化する
+    static std::shared_ptr<const ConvolutionIR> create(const juce::AudioBuffer<float>& impulseResponse,
+                                                       double impulseResponseSampleRate,
+                                                       double sampleRate)
+    {
+        if (impulseResponse.getNumChannels() == 0 || impulseResponse.getNumSamples() == 0
+            || impulseResponseSampleRate <= 0.0 || sampleRate <= 0.0)
+            return nullptr;
+
+        auto ir = std::shared_ptr<ConvolutionIR>(new ConvolutionIR());
+        ir->sampleRate = sampleRate;
+        ir->tailBlockSize = tailBlockSizeFor(sampleRate);
+
+        const int numIRChannels = impulseResponse.getNumChannels();
+        if (numIRChannels == 1)
+        {
+            ir->numFilters = 1;
+            ir->numPaths = 2;
+            ir->paths[0] = { 0, 0, 0 };
+            ir->paths[1] = { 1, 1, 0 };
+        }
+        else if (numIRChannels == 4)
+        {
+            ir->numFilters = 4;
+            ir->numPaths = 4;
+            ir->paths[0] = { 0, 0, 0 };   // L → L
+            ir->paths[1] = { 0, 1, 1 };   // L → R
+            ir->paths[2] = { 1, 0, 2 };   // R → L
+            ir->paths[3] = { 1, 1, 3 };   // R → R
+        }
+        else
+        {
+            ir->numFilters = 2;
+            ir->numPaths = 2;
+            ir->paths[0] = { 0, 0, 0 };
+            ir->paths[1] = { 1, 1, 1 };
+        }
+
+        // サンプルレートを合わせる
+        const double ratio = impulseResponseSampleRate / sampleRate;
+        const int maxLength = static_cast<int>(maxLengthSeconds * sampleRate);
+        ir->length = std::min(maxLength, static_cast<int>(std::ceil(impulseResponse.getNumSamples() / ratio)));
+
+        juce::AudioBuffer<float> resampled(ir->numFilters, ir->length);
+        for (int f = 0; f < ir->numFilters; ++f)
+        {
+            if (ratio == 1.0)
+            {
+                resampled.copyFrom(f, 0, impulseResponse, f, 0, ir->length);
+            }
+            else
+            {
+                // 末尾を補間するための余白を付けて Lagrange 補間
+                juce::AudioBuffer<float> padded(1, impulseResponse.getNumSamples() + 8);
+                padded.clear();
+                padded.copyFrom(0, 0, impulseResponse, f, 0, impulseResponse.getNumSamples());
+
+                juce::LagrangeInterpolator interpolator;
+                interpolator.process(ratio, padded.getReadPointer(0), resampled.getWritePointer(f), ir->length);
+            }
+        }
+
+        // 正規化（出力ごとに、そこへ入る経路のエネルギーを合計）
+        double maxEnergy = 0.0;
+        for (int output = 0; output < 2; ++output)
+        {
+            double energy = 0.0;
+            for (int p = 0; p < ir->numPaths; ++p)
+            {
+                if (ir->paths[p].output != output)
+                    continue;
+                const float* h = resampled.getReadPointer(ir->paths[p].filter);
+                for (int i = 0; i < ir->length; ++i)
+                    energy += static_cast<double>(h[i]) * h[i];
+            }
+            maxEnergy = std::max(maxEnergy, energy);
+        }
+        if (maxEnergy > 0.0)
+            resampled.applyGain(static_cast<float>(1.0 / std::sqrt(maxEnergy)));
+
+        ir->buildPartitions(resampled);
+        return ir;
+    }
+
+    double getSampleRate() const { return sampleRate; }
+    int getLengthInSamples() const { return length; }
+    int getTailBlockSize() const { return tailBlockSize; }
+    int getNumHeadPartitions() const { return numHeadPartitions; }
+    int getNumTailPartitions() const { return numTailPartitions; }
+    bool hasTail() const { return numTailPartitions > 0; }
+
+    // 48kHz で 1024、それより高いレートでは同じ時間になるよう 2 のべき乗で伸ばす
+    static int tailBlockSizeFor(double sampleRate)
+    {
+        return std::max(1024, juce::nextPowerOfTwo(static_cast<int>(1024.0 * sampleRate / 48000.0)));
+    }
+
+private:
+    friend class PartitionedConvolver;
+
+    ConvolutionIR() = default;
+
+    void buildPartitions(const juce::AudioBuffer<float>& h)
+    {
+        constexpr int B = headBlockSize;
+        const int T = tailBlockSize;
+        const int headEnd = std::min(length, 2 * T);
+
+        numHeadPartitions = std::max(0, (headEnd - B + B - 1) / B);
+        numTailPartitions = std::max(0, (length - 2 * T + T - 1) / T);
+
+        juce::dsp::FFT headFFT(juce::roundToInt(std::log2(2 * B)));
+        juce::dsp::FFT tailFFT(juce::roundToInt(std::log2(2 * T)));
+        std::vector<float> work(static_cast<size_t>(4 * T));
+
+        for (int f = 0; f < numFilters; ++f)
+        {
+            const float* data = h.getReadPointer(f);
+
+            // 先頭 B タップ（直接畳み込み用に逆順で持つ）
+            auto& taps = headTaps[f];
+            taps.assign(B, 0.0f);
+            for (int k = 0; k < std::min(B, length); ++k)
+                taps[static_cast<size_t>(B - 1 - k)] = data[k];
+
+            // [B, 2T) を B ごとに
+            headSpectra[f].assign(static_cast<size_t>(numHeadPartitions * 2 * (B + 1)), 0.0f);
+            for (int p = 0; p < numHeadPartitions; ++p)
+            {
+                const int start = B + p * B;
+                float* re = headSpectra[f].data() + p * 2 * (B + 1);
+                partitionSpectrum(headFFT, work.data(), data + start, std::min(B, headEnd - start), 2 * B,
+                                  re, re + (B + 1));
+            }
+
+            // [2T, 末尾) を T ごとに
+            tailSpectra[f].assign(static_cast<size_t>(numTailPartitions * 2 * (T + 1)), 0.0f);
+            for (int p = 0; p < numTailPartitions; ++p)
+            {
+                const int start = 2 * T + p * T;
+                float* re = tailSpectra[f].data() + p * 2 * (T + 1);
+                partitionSpectrum(tailFFT, work.data(), data + start, std::min(T, length - start), 2 * T,
+                                  re, re + (T + 1));
+            }
+        }
+    }
+
+    // 区間を FFT サイズまでゼロ詰めして変換し、0 〜 ナイキストのビンを re / im に分けて保存
+    static void partitionSpectrum(juce::dsp::FFT& fft, float* work, const float* segment, int segmentLength,
+                                  int fftSize, float* re, float* im)
+    {
+        std::fill(work, work + 2 * fftSize, 0.0f);
+        std::copy(segment, segment + segmentLength, work);
+        fft.performRealOnlyForwardTransform(work, true);
+
+        for (int k = 0; k <= fftSize / 2; ++k)
+        {
+            re[k] = work[2 * k];
+            im[k] = work[2 * k + 1];
+        }
+    }
+
+    double sampleRate = 44100.0;
+    int length = 0;
+    int tailBlockSize = 1024;
+    int numHeadPartitions = 0;
+    int numTailPartitions = 0;
+
+    int numFilters = 0;
+    int numPaths = 0;
+    Path paths[4] {};
+
+    // フィルターごと: 先頭タップ（逆順）と、各分割のスペクトル [分割][re (N/2+1), im (N/2+1)]
+    std::array<std::vector<float>, 4> headTaps;
+    std::array<std::vector<float>, 4> headSpectra;
+    std::array<std::vector<float>, 4> tailSpectra;
+};
+
+//==============================================================================
+// ステレオ入力 → ステレオ出力（wet のみ）の分割畳み込み
+// process() はオーディオスレッド、runPendingTailJob() はワーカースレッド
+// （同期モードではオーディオスレッド）から呼ぶ
+class PartitionedConvolver
+{
+public:
+    static constexpr int numTailSlots = 8;
+
+    PartitionedConvolver() = default;
+    ~PartitionedConvolver() = default;
+
+    // IR に合わせて状態を確保（ワーカーを止めた状態で呼ぶこと）
+    void prepare(std::shared_ptr<const ConvolutionIR> newImpulseResponse, bool synchronousTail)
+    {
+        ir = std::move(newImpulseResponse);
+        synchronous = synchronousTail;
+
+        if (ir == nullptr)
+        {
+            headFFT.reset();
+            tailFFT.reset();
+            return;
+        }
+
+        constexpr int B = ConvolutionIR::headBlockSize;
+        const int T = ir->tailBlockSize;
+        const int headBins = B + 1;
+        const int tailBins = T + 1;
+
+        headFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * B)));
+        tailFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * T)));
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            headFrame[ch].assign(2 * B, 0.0f);
+            headOutput[ch].assign(B, 0.0f);
+            headHistory[ch].assign(static_cast<size_t>(std::max(1, ir->numHeadPartitions) * 2 * headBins), 0.0f);
+
+            tailPrevious[ch].assign(T, 0.0f);
+            tailHistory[ch].assign(static_cast<size_t>(std::max(1, ir->numTailPartitions) * 2 * tailBins), 0.0f);
+        }
+
+        headWork.assign(4 * B, 0.0f);
+        headAccumulator.assign(2 * headBins, 0.0f);
+        tailWork.assign(4 * T, 0.0f);
+        tailAccumulator.assign(2 * tailBins, 0.0f);
+        tailInputSlots.assign(static_cast<size_t>(numTailSlots * 2 * T), 0.0f);
+        tailOutputSlots.assign(static_cast<size_t>(numTailSlots * 2 * T), 0.0f);
+        droppedInput.assign(static_cast<size_t>(2 * T), 0.0f);
+
+        tailJobIndex = 0;
+        submittedJobs.store(0);
+        processedJobs.store(0);
+        firstValidJob.store(0);
+        lastComputedJob = -1;
+        underruns.store(0);
+
+        reset();
+    }
+
+    // 状態をクリア（オーディオスレッドから呼んでよい）
+    // テールは次のジョブ番号から有効にし、ワーカーが計算中の古いジョブの結果は捨てる
+    void reset()
+    {
+        if (ir == nullptr)
+            return;
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            std::fill(headFrame[ch].begin(), headFrame[ch].end(), 0.0f);
+            std::fill(headOutput[ch].begin(), headOutput[ch].end(), 0.0f);
+            std::fill(headHistory[ch].begin(), headHistory[ch].end(), 0.0f);
+        }
+        headPosition = 0;
+        headHistoryIndex = 0;
+
+        tailPosition = 0;
+        firstValidJob.store(tailJobIndex, std::memory_order_release);
+        beginTailBlock();
+    }
+
+    bool isReady() const { return ir != nullptr; }
+    int getNumUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+
+    // ブロック処理（in と out は別のバッファ）
+    void process(const float* inputL, const float* inputR, float* outputL, float* outputR, int numSamples)
+    {
+        constexpr int B = ConvolutionIR::headBlockSize;
+        const int T = ir->tailBlockSize;
+        const float* input[2] = { inputL, inputR };
+        float* output[2] = { outputL, outputR };
+
+        int done = 0;
+        while (done < numSamples)
+        {
+            // 先頭区間・テール区間のブロック境界をまたがない長さずつ
+            const int n = std::min({ numSamples - done, B - headPosition, T - tailPosition });
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                std::copy(input[ch] + done, input[ch] + done + n, headFrame[ch].data() + B + headPosition);
+                std::copy(input[ch] + done, input[ch] + done + n, currentTailInput[ch] + tailPosition);
+
+                // 前のブロックで計算した [B, 2T) の結果 + 2ブロック前の入力に対するテール
+                std::copy(headOutput[ch].data() + headPosition, headOutput[ch].data() + headPosition + n,
+                          output[ch] + done);
+                if (currentTailOutput[ch] != nullptr)
+                    juce::FloatVectorOperations::add(output[ch] + done, currentTailOutput[ch] + tailPosition, n);
+            }
+
+            // 先頭 B タップを直接畳み込み
+            for (int p = 0; p < ir->numPaths; ++p)
+            {
+                const auto& path = ir->paths[p];
+                const float* taps = ir->headTaps[static_cast<size_t>(path.filter)].data();
+                const float* x = headFrame[path.input].data() + 1 + headPosition;
+                float* y = output[path.output] + done;
+
+                for (int i = 0; i < n; ++i)
+                {
+                    float sum = 0.0f;
+                    for (int k = 0; k < B; ++k)
+                        sum += taps[k] * x[i + k];
+                    y[i] += sum;
+                }
+            }
+
+            done += n;
+            headPosition += n;
+            tailPosition += n;
+
+            if (headPosition == B)
+                finishHeadBlock();
+            if (tailPosition == T)
+                finishTailBlock();
+        }
+    }
+
+    // 投入済みのテールジョブを1つ計算する（なければ false）
+    bool runPendingTailJob()
+    {
+        const juce::int64 job = processedJobs.load(std::memory_order_relaxed);
+        if (ir == nullptr || job >= submittedJobs.load(std::memory_order_acquire))
+            return false;
+
+        const juce::int64 first = firstValidJob.load(std::memory_order_acquire);
+        if (job >= first)
+            computeTailJob(job, first);
+
+        processedJobs.store(job + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    float* tailInput(juce::int64 job, int ch)
+    {
+        return tailInputSlots.data() + (static_cast<int>(job % numTailSlots) * 2 + ch) * ir->tailBlockSize;
+    }
+
+    float* tailOutput(juce::int64 job, int ch)
+    {
+        return tailOutputSlots.data() + (static_cast<int>(job % numTailSlots) * 2 + ch) * ir->tailBlockSize;
+    }
+
+    // acc += x * h（複素数、re / im 分離）
+    static void multiplyAccumulate(float* accRe, float* accIm, const float* xRe, const float* xIm,
+                                   const float* hRe, const float* hIm, int numBins)
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+            accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+        }
+    }
+
+    // [前のブロック | このブロック] の 2N サンプルを変換して履歴に保存
+    static void forwardFrame(juce::dsp::FFT& fft, float* work, int fftSize, float* re, float* im)
+    {
+        std::fill(work + fftSize, work + 2 * fftSize, 0.0f);
+        fft.performRealOnlyForwardTransform(work, true);
+        for (int k = 0; k <= fftSize / 2; ++k)
+        {
+            re[k] = work[2 * k];
+            im[k] = work[2 * k + 1];
+        }
+    }
+
+    // 累積したスペクトルを逆変換し、後半 N サンプル（巡回の影響を受けない部分）を取り出す
+    static void inverseFrame(juce::dsp::FFT& fft, float* work, int fftSize, const float* re, const float* im,
+                             float* output)
+    {
+        for (int k = 0; k <= fftSize / 2; ++k)
+        {
+            work[2 * k] = re[k];
+            work[2 * k + 1] = im[k];
+        }
+        fft.performRealOnlyInverseTransform(work);
+        std::copy(work + fftSize / 2, work + fftSize, output);
+    }
+
+    // [B, 2T) の一様分割畳み込み（次の B サンプルで使う結果を計算）
+    void finishHeadBlock()
+    {
+        constexpr int B = ConvolutionIR::headBlockSize;
+        constexpr int bins = B + 1;
+        const int numPartitions = ir->numHeadPartitions;
+
+        if (numPartitions > 0)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                float* re = headHistory[ch].data() + headHistoryIndex * 2 * bins;
+                std::copy(headFrame[ch].begin(), headFrame[ch].end(), headWork.begin());
+                forwardFrame(*headFFT, headWork.data(), 2 * B, re, re + bins);
+            }
+
+            for (int output = 0; output < 2; ++output)
+            {
+                std::fill(headAccumulator.begin(), headAccumulator.end(), 0.0f);
+                float* accRe = headAccumulator.data();
+                float* accIm = accRe + bins;
+
+                for (int p = 0; p < ir->numPaths; ++p)
+                {
+                    const auto& path = ir->paths[p];
+                    if (path.output != output)
+                        continue;
+
+                    const float* h = ir->headSpectra[static_cast<size_t>(path.filter)].data();
+                    for (int k = 0; k < numPartitions; ++k)
+                    {
+                        const int slot = (headHistoryIndex - k + numPartitions) % numPartitions;
+                        const float* x = headHistory[path.input].data() + slot * 2 * bins;
+                        multiplyAccumulate(accRe, accIm, x, x + bins, h + k * 2 * bins, h + k * 2 * bins + bins, bins);
+                    }
+                }
+
+                inverseFrame(*headFFT, headWork.data(), 2 * B, accRe, accIm, headOutput[output].data());
+            }
+
+            headHistoryIndex = (headHistoryIndex + 1) % numPartitions;
+        }
+
+        // このブロックを「前のブロック」へ
+        for (int ch = 0; ch < 2; ++ch)
+            std::copy(headFrame[ch].begin() + B, headFrame[ch].end(), headFrame[ch].begin());
+        headPosition = 0;
+    }
+
+    // T サンプルたまったらテールのジョブとして投入
+    void finishTailBlock()
+    {
+        if (ir->hasTail())
+        {
+            submittedJobs.store(tailJobIndex + 1, std::memory_order_release);
+            if (synchronous)
+                runPendingTailJob();
+        }
+
+        ++tailJobIndex;
+        tailPosition = 0;
+        beginTailBlock();
+    }
+
+    // 新しい T ブロックの開始: 入力をためる場所と、このブロックで足すテール
+    // （2ブロック前の入力に対する結果）を決める
+    void beginTailBlock()
+    {
+        currentTailInput[0] = tailInput(tailJobIndex, 0);
+        currentTailInput[1] = tailInput(tailJobIndex, 1);
+        currentTailOutput[0] = currentTailOutput[1] = nullptr;
+        if (! ir->hasTail())
+            return;
+
+        // ワーカーが numTailSlots ブロック遅れていると、このブロックのスロットはまだ読まれている。
+        // 入力は捨て場にためてこのジョブは飛ばさせ、次のジョブからテールをやり直す
+        if (processedJobs.load(std::memory_order_acquire) <= tailJobIndex - numTailSlots)
+        {
+            currentTailInput[0] = droppedInput.data();
+            currentTailInput[1] = droppedInput.data() + ir->tailBlockSize;
+            firstValidJob.store(tailJobIndex + 1, std::memory_order_release);
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const juce::int64 job = tailJobIndex - 2;
+        if (job < firstValidJob.load(std::memory_order_relaxed))
+            return;
+
+        if (processedJobs.load(std::memory_order_acquire) > job)
+        {
+            currentTailOutput[0] = tailOutput(job, 0);
+            currentTailOutput[1] = tailOutput(job, 1);
+        }
+        else
+        {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // [2T, 末尾) の一様分割畳み込み（ワーカースレッド）
+    void computeTailJob(juce::int64 job, juce::int64 first)
+    {
+        const int T = ir->tailBlockSize;
+        const int bins = T + 1;
+        const int numPartitions = ir->numTailPartitions;
+        const int historyIndex = static_cast<int>(job % numPartitions);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            // 前のブロックが無効（リセット直後・スキップ）なら 0 として扱う
+            if (lastComputedJob != job - 1 || job - 1 < first)
+                std::fill(tailPrevious[ch].begin(), tailPrevious[ch].end(), 0.0f);
+
+            const float* current = tailInput(job, ch);
+            std::copy(tailPrevious[ch].begin(), tailPrevious[ch].end(), tailWork.begin());
+            std::copy(current, current + T, tailWork.begin() + T);
+
+            float* re = tailHistory[ch].data() + historyIndex * 2 * bins;
+            forwardFrame(*tailFFT, tailWork.data(), 2 * T, re, re + bins);
+
+            std::copy(current, current + T, tailPrevious[ch].begin());
+        }
+        lastComputedJob = job;
+
+        // リセット前の入力（first より前のジョブ）は使わない
+        const int numValid = static_cast<int>(std::min<juce::int64>(numPartitions, job - first + 1));
+
+        for (int output = 0; output < 2; ++output)
+        {
+            std::fill(tailAccumulator.begin(), tailAccumulator.end(), 0.0f);
+            float* accRe = tailAccumulator.data();
+            float* accIm = accRe + bins;
+
+            for (int p = 0; p < ir->numPaths; ++p)
+            {
+                const auto& path = ir->paths[p];
+                if (path.output != output)
+                    continue;
+
+                const float* h = ir->tailSpectra[static_cast<size_t>(path.filter)].data();
+                for (int k = 0; k < numValid; ++k)
+                {
+                    const int slot = (historyIndex - k + numPartitions) % numPartitions;
+                    const float* x = tailHistory[path.input].data() + slot * 2 * bins;
+                    multiplyAccumulate(accRe, accIm, x, x + bins, h + k * 2 * bins, h + k * 2 * bins + bins, bins);
+                }
+            }
+
+            inverseFrame(*tailFFT, tailWork.data(), 2 * T, accRe, accIm, tailOutput(job, output));
+        }
+    }
+
+    std::shared_ptr<const ConvolutionIR> ir;
+    bool synchronous = false;
+
+    // 先頭区間（オーディオスレッドのみ）
+    std::unique_ptr<juce::dsp::FFT> headFFT;
+    std::vector<float> headFrame[2];      // [前のブロック | このブロック]（2B）
+    std::vector<float> headOutput[2];     // このブロックで足す [B, 2T) の結果（B）
+    std::vector<float> headHistory[2];    // 入力スペクトルの履歴 [分割][re, im]
+    std::vector<float> headWork;
+    std::vector<float> headAccumulator;
+    int headPosition = 0;
+    int headHistoryIndex = 0;
+
+    // テール区間: オーディオスレッド側
+    juce::int64 tailJobIndex = 0;         // いま入力をためているブロックの番号
+    int tailPosition = 0;
+    float* currentTailInput[2] = {};
+    const float* currentTailOutput[2] = {};
+    std::vector<float> droppedInput;      // ワーカーが遅れているブロックの入力（使わない）
+
+    // テール区間: スレッド間で共有（スロットはジョブ番号 % numTailSlots）
+    std::vector<float> tailInputSlots;
+    std::vector<float> tailOutputSlots;
+    std::atomic<juce::int64> submittedJobs { 0 };
+    std::atomic<juce::int64> processedJobs { 0 };
+    std::atomic<juce::int64> firstValidJob { 0 };
+    std::atomic<int> underruns { 0 };
+
+    // テール区間: ワーカー側
+    std::unique_ptr<juce::dsp::FFT> tailFFT;
+    std::vector<float> tailPrevious[2];
+    std::vector<float> tailHistory[2];
+    std::vector<float> tailWork;
+    std::vector<float> tailAccumulator;
+    juce::int64 lastComputedJob = -1;
+};
+
+//==============================================================================
+// テール区間を計算するワーカースレッド（複数の畳み込みをまとめて受け持つ）
+// オーディオスレッドからは起こさず、1ms ごとに投入済みのジョブを確認する
+class ConvolutionWorker : public juce::Thread
+{
+public:
+    ConvolutionWorker() : juce::Thread("DomeLive Convolution") {}
+    ~ConvolutionWorker() override { stopThread(1000); }
+
+    // 受け持つ畳み込みを設定（スレッドを止めた状態で呼ぶこと）
+    void setConvolvers(std::vector<PartitionedConvolver*> newConvolvers)
+    {
+        jassert(! isThreadRunning());
+        convolvers = std::move(newConvolvers);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            bool didWork = false;
+            for (auto* convolver : convolvers)
+                while (convolver->runPendingTailJob())
+                    didWork = true;
+
+            if (! didWork)
+                wait(1);
+        }
+    }
+
+private:
+    std::vector<PartitionedConvolver*> convolvers;
+};
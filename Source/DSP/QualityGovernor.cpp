@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    QualityGovernor.cpp
+    処理時間による品質の自動調整の実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+    QualityGovernor.h
+    処理時間を見て品質を自動で下げる（上げ戻す）ガバナー
+
+    オーディオスレッドはブロックごとにリバーブの処理時間を addMeasurement() で渡す。
+    処理時間をブロックの長さで割った負荷を約 0.25 秒ごとにまとめ、
+      予算（デフォルトはブロック時間の 25%）を超えたら 1 段下げる
+      予算の 40% 未満が 10 秒続いたら 1 段戻す（1 段上げるとコストは約 2 倍になるため）
+    下げる段数は選んだ品質より下にある段数（setAvailableSteps()）まで。Eco を選んでいるときの
+    過負荷で段数だけが積み上がり、あとで High を選んでも Eco のまま、ということにならない。
+    ブロック1つの突発的な遅れでは動かない。確保もロックもしない。
+    品質を切り替えると、前の品質のタンクが settleSeconds の間だけ新しいタンクと並んで動き、
+    負荷が一時的に上がる。切り替えた後は settleSeconds の間の測定を捨て、その後の
+    まるまる1窓で判断する（High から1回の過負荷で Eco まで続けて落ちないように）。
+  ==============================================================================
+*/
+
+#pragma once
+#include <algorithm>
+
+class QualityGovernor
+{
+public:
+    static constexpr int maxStepsDown = 2;   // High → Eco
+
+    // サンプルレートと切り替え後に測定を捨てる時間を設定して状態を戻す（下げた段数も 0 に戻す）
+    void prepare(double newSampleRate, double newSettleSeconds)
+    {
+        sampleRate = newSampleRate;
+        settleSeconds = std::max(0.0, newSettleSeconds);
+        reset();
+    }
+
+    void reset()
+    {
+        stepsDown = 0;
+        windowProcessSeconds = 0.0;
+        windowAudioSeconds = 0.0;
+        headroomSeconds = 0.0;
+        holdOffSeconds = 0.0;
+    }
+
+    // 選んだ品質から下げられる段数（選んだ品質の番号、Eco = 0）。ブロックごとに呼ぶ
+    // 選んだ品質が変わったら、前の品質のタンクが鳴り終わるまで測定を捨てる
+    void setAvailableSteps(int steps)
+    {
+        steps = std::clamp(steps, 0, maxStepsDown);
+        if (steps == availableSteps)
+            return;
+
+        availableSteps = steps;
+        stepsDown = std::min(stepsDown, availableSteps);
+        startHoldOff();
+    }
+
+    // 負荷の予算（ブロックの長さに対する処理時間の割合、0 - 1）
+    void setBudget(double newBudget) { budget = std::clamp(newBudget, 0.01, 1.0); }
+    double getBudget() const { return budget; }
+
+    // 1ブロックの処理時間（秒）を報告する
+    void addMeasurement(double processSeconds, int numSamples)
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        // 切り替えの直後（前の品質のタンクがまだ鳴っている間）は数えない
+        if (holdOffSeconds > 0.0)
+        {
+            holdOffSeconds -= numSamples / sampleRate;
+            return;
+        }
+
+        windowProcessSeconds += processSeconds;
+        windowAudioSeconds += numSamples / sampleRate;
+        if (windowAudioSeconds < windowSeconds)
+            return;
+
+        const double load = windowProcessSeconds / windowAudioSeconds;
+        if (load > budget)
+        {
+            headroomSeconds = 0.0;
+            if (stepsDown < availableSteps)
+            {
+                ++stepsDown;
+                startHoldOff();
+            }
+        }
+        else if (load < budget * stepUpHeadroom && stepsDown > 0)
+        {
+            headroomSeconds += windowAudioSeconds;
+            if (headroomSeconds >= stepUpSeconds)
+            {
+                --stepsDown;
+                headroomSeconds = 0.0;
+                startHoldOff();
+            }
+        }
+        else
+        {
+            headroomSeconds = 0.0;
+        }
+
+        windowProcessSeconds = 0.0;
+        windowAudioSeconds = 0.0;
+    }
+
+    // 選んだ品質から何段下げているか
+    int getStepsDown() const { return stepsDown; }
+
+private:
+    // 品質を切り替えたので、窓を捨てて settleSeconds の間は測定しない
+    void startHoldOff()
+    {
+        holdOffSeconds = settleSeconds;
+        windowProcessSeconds = 0.0;
+        windowAudioSeconds = 0.0;
+    }
+
+    static constexpr double windowSeconds = 0.25;
+    static constexpr double stepUpHeadroom = 0.4;
+    static constexpr double stepUpSeconds = 10.0;
+
+    double sampleRate = 44100.0;
+    double budget = 0.25;
+    int stepsDown = 0;
+    int availableSteps = maxStepsDown;
+    double windowProcessSeconds = 0.0;
+    double windowAudioSeconds = 0.0;
+    double headroomSeconds = 0.0;
+    double settleSeconds = 0.0;
+    double holdOffSeconds = 0.0;
+};
@@ -0,0 +1,10 @@
+/*
+  ==============================================================================
+    StageProfiler.cpp
+    ステージごとの処理時間の計測の実装ファイル（ヘッダーオンリーなので空）
+  ==============================================================================
+*/
+
+#include "StageProfiler.h"
+
+// 実装はすべてヘッダーファイルに記述（インライン化のため）
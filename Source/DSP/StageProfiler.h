@@ -0,0 +1,429 @@
+/*
+  ==============================================================================
+    StageProfiler.h
+    DomeReverb のステージごとの処理時間の計測（プロファイル用ビルドのみ）
+
+    プロファイル用ビルド（DOMELIVE_STAGE_PROFILING=1、CMake の DOMELIVE_STAGE_PROFILING=ON）では、
+    ScopedStage がスコープの前後で TSC（x86 は rdtsc、ARM64 は cntvct_el0）を読み、
+    スレッドごとのバッファにステージ別の時間と回数を足し込む。
+    スレッドでいちばん外側のスコープ（DomeReverb::process() やレーンのワーカーのジョブ）が
+    閉じたところで1ブロック分を記録にまとめ、スレッドごとのリングバッファ（書き手1・読み手1）に積む。
+    確保もロックもしない（スレッドごとの枠は maxThreads 個の静的な配列から atomic で取る）。
+    記録はオーディオスレッド以外から collect() で取り出し、Session が Chrome のトレース
+    （chrome://tracing / Perfetto で開ける JSON）と集計表にする。
+    通常ビルドでは ScopedStage は何もしない空のクラスになり、コストはかからない。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+ #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+ #include <x86intrin.h>
+#endif
+
+#ifndef DOMELIVE_STAGE_PROFILING
+ #define DOMELIVE_STAGE_PROFILING 0
+#endif
+
+namespace StageProfiler
+{
+    constexpr bool enabled = DOMELIVE_STAGE_PROFILING != 0;
+
+    enum class Stage : int
+    {
+        Process,            // DomeReverb::process() 全体（ブロックの単位）
+        LaneJob,            // レーンのワーカーが続けて取ったレーン（ワーカー側のブロックの単位）
+        PreEq,
+        EarlyReflections,
+        PreDelay,
+        Combs,
+        Crossfeed,
+        AllPass,
+        Fdn,
+        Convolution,
+        PostFilter,
+        Width,
+        Resample,           // 内部レートへの間引きと補間
+        Mix,                // Wet/Dry ミックス
+        numStages
+    };
+
+    constexpr int numStages = static_cast<int>(Stage::numStages);
+
+    inline const char* getStageName(Stage stage)
+    {
+        static const char* names[] = { "process", "laneWorker", "preEq", "earlyReflections", "preDelay",
+                                       "combs", "crossfeed", "allPass", "fdn", "convolution",
+                                       "postFilter", "width", "resample", "mix" };
+        return names[static_cast<int>(stage)];
+    }
+
+    // 1ブロック分（いちばん外側のスコープ1回分）の記録
+    struct BlockRecord
+    {
+        std::uint64_t start = 0, end = 0;   // いちばん外側のスコープの TSC
+        Stage root = Stage::Process;
+        int numSamples = 0;
+        std::uint64_t stageTicks[numStages] = {};
+        std::uint32_t stageCalls[numStages] = {};
+    };
+
+    // TSC（なければ steady_clock）。単位の換算は ticksPerSecond()
+    inline std::uint64_t readTicks() noexcept
+    {
+       #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+       #elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+       #elif defined(__aarch64__)
+        std::uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+       #else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+       #endif
+    }
+
+    // readTicks() の1秒あたりのカウント（最初の呼び出しで steady_clock と比べて 20ms 測る）
+    inline double ticksPerSecond()
+    {
+        static const double rate = []
+        {
+            const auto clockStart = std::chrono::steady_clock::now();
+            const auto tickStart = readTicks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const auto tickEnd = readTicks();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - clockStart;
+            return static_cast<double>(tickEnd - tickStart) / elapsed.count();
+        }();
+        return rate;
+    }
+
+#if DOMELIVE_STAGE_PROFILING
+    constexpr int maxThreads = 8;
+    constexpr int ringSize = 2048;   // collect() の間隔でこれを超えた分は捨てて数える
+
+    // スレッド1つ分の枠。書くのは持ち主のスレッドだけ、読むのは collect() だけ
+    struct ThreadBuffer
+    {
+        std::atomic<bool> inUse { false };
+        int depth = 0;
+        BlockRecord current;
+
+        BlockRecord ring[ringSize];
+        std::atomic<std::uint32_t> writeCount { 0 };
+        std::atomic<std::uint32_t> readCount { 0 };
+        std::atomic<std::uint32_t> dropped { 0 };
+
+        void push() noexcept
+        {
+            const auto w = writeCount.load(std::memory_order_relaxed);
+            if (w - readCount.load(std::memory_order_acquire) >= static_cast<std::uint32_t>(ringSize))
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            ring[w % ringSize] = current;
+            writeCount.store(w + 1, std::memory_order_release);
+        }
+    };
+
+    inline ThreadBuffer threadBuffers[maxThreads];
+
+    // スレッドが終わったら枠を返す（ワーカーを作り直しても枠が尽きないように）
+    struct ThreadSlot
+    {
+        ThreadBuffer* buffer = nullptr;
+
+        ThreadSlot() noexcept
+        {
+            for (auto& candidate : threadBuffers)
+            {
+                bool expected = false;
+                if (candidate.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    candidate.depth = 0;
+                    buffer = &candidate;
+                    return;
+                }
+            }
+        }
+
+        ~ThreadSlot()
+        {
+            if (buffer != nullptr)
+                buffer->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    inline ThreadBuffer* getThreadBuffer() noexcept
+    {
+        thread_local ThreadSlot slot;   // 枠が足りなければ nullptr（そのスレッドは測らない）
+        return slot.buffer;
+    }
+
+    // スコープの間をステージ stage の時間とする。
+    // いちばん外側のスコープはブロックの単位になり、numSamples はそのブロックの長さ
+    class ScopedStage
+    {
+    public:
+        explicit ScopedStage(Stage stageToTime, int numSamples = 0) noexcept
+            : buffer(getThreadBuffer()), stage(stageToTime)
+        {
+            if (buffer == nullptr)
+                return;
+
+            if (buffer->depth++ == 0)
+            {
+                buffer->current = {};
+                buffer->current.root = stage;
+                buffer->current.numSamples = numSamples;
+            }
+            start = readTicks();
+        }
+
+        ~ScopedStage()
+        {
+            if (buffer == nullptr)
+                return;
+
+            const auto end = readTicks();
+            auto& record = buffer->current;
+            if (--buffer->depth == 0)
+            {
+                record.start = start;
+                record.end = end;
+                buffer->push();
+                return;
+            }
+
+            record.stageTicks[static_cast<int>(stage)] += end - start;
+            ++record.stageCalls[static_cast<int>(stage)];
+        }
+
+        ScopedStage(const ScopedStage&) = delete;
+        ScopedStage& operator=(const ScopedStage&) = delete;
+
+    private:
+        ThreadBuffer* buffer;
+        Stage stage;
+        std::uint64_t start = 0;
+    };
+
+    // 溜まった記録をスレッドの枠ごとに fn(threadIndex, record) へ渡す（オーディオスレッド以外から）
+    // 戻り値はリングがあふれて捨てた記録の数
+    template <typename Function>
+    int collect(Function&& fn)
+    {
+        int dropped = 0;
+        for (int t = 0; t < maxThreads; ++t)
+        {
+            auto& buffer = threadBuffers[t];
+            const auto w = buffer.writeCount.load(std::memory_order_acquire);
+            auto r = buffer.readCount.load(std::memory_order_relaxed);
+            for (; r != w; ++r)
+                fn(t, buffer.ring[r % ringSize]);
+            buffer.readCount.store(r, std::memory_order_release);
+            dropped += static_cast<int>(buffer.dropped.exchange(0, std::memory_order_relaxed));
+        }
+        return dropped;
+    }
+#else
+    class ScopedStage
+    {
+    public:
+        explicit ScopedStage(Stage, int = 0) noexcept {}
+    };
+
+    template <typename Function>
+    int collect(Function&&) { return 0; }
+#endif
+
+    //==========================================================================
+    // 取り出した記録を構成（section）ごとにまとめ、Chrome のトレースと集計表にする
+    class Session
+    {
+    public:
+        // 以降の記録を新しい構成として数える（トレースでは別のプロセスとして並ぶ）
+        void beginSection(const juce::String& label)
+        {
+            sections.push_back({});
+            sections.back().label = label;
+        }
+
+        // スレッドのバッファから取り込む
+        void collect()
+        {
+            jassert(! sections.empty());
+            auto& section = sections.back();
+            section.dropped += StageProfiler::collect([&](int thread, const BlockRecord& record)
+            {
+                if (firstTick == 0 || record.start < firstTick)
+                    firstTick = record.start;
+                section.blocks.push_back({ thread, record });
+            });
+        }
+
+        // 取り込まずに捨てる（ウォームアップの分など）
+        void discard()
+        {
+            StageProfiler::collect([](int, const BlockRecord&) {});
+        }
+
+        // 集計表の見出しに添える値（ハードウェアカウンターなど）
+        void addCounter(const juce::String& name, double value)
+        {
+            jassert(! sections.empty());
+            sections.back().counters.push_back({ name, value });
+        }
+
+        // Chrome のトレース（Trace Event Format）。ブロックは "X"、ステージ別の時間（ns）は
+        // ブロックごとの "C"（積み上げのグラフになる）
+        juce::String toChromeTrace() const
+        {
+            const double microsecondsPerTick = 1.0e6 / ticksPerSecond();
+            juce::String json;
+            json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+            bool first = true;
+            auto addEvent = [&](const juce::String& event)
+            {
+                json << (first ? "" : ",\n") << event;
+                first = false;
+            };
+
+            for (size_t s = 0; s < sections.size(); ++s)
+            {
+                const auto& section = sections[s];
+                const int pid = static_cast<int>(s) + 1;
+                addEvent("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + juce::String(pid)
+                         + ",\"args\":{\"name\":" + juce::JSON::toString(section.label) + "}}");
+
+                juce::Array<int> namedThreads;
+                for (const auto& block : section.blocks)
+                {
+                    const auto& r = block.record;
+                    const auto common = ",\"pid\":" + juce::String(pid) + ",\"tid\":" + juce::String(block.thread)
+                                      + ",\"ts\":" + juce::String(static_cast<double>(r.start - firstTick) * microsecondsPerTick, 3);
+
+                    if (! namedThreads.contains(block.thread))
+                    {
+                        namedThreads.add(block.thread);
+                        addEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + juce::String(pid)
+                                 + ",\"tid\":" + juce::String(block.thread) + ",\"args\":{\"name\":\""
+                                 + (r.root == Stage::Process ? "DomeReverb::process" : getStageName(r.root)) + "\"}}");
+                    }
+
+                    addEvent("{\"name\":\"" + juce::String(getStageName(r.root)) + "\",\"ph\":\"X\"" + common
+                             + ",\"dur\":" + juce::String(static_cast<double>(r.end - r.start) * microsecondsPerTick, 3)
+                             + ",\"args\":{\"samples\":" + juce::String(r.numSamples) + "}}");
+
+                    juce::String args;
+                    for (int st = 0; st < numStages; ++st)
+                        if (r.stageCalls[st] > 0)
+                            args << (args.isEmpty() ? "" : ",") << "\"" << getStageName(static_cast<Stage>(st)) << "\":"
+                                 << juce::String(static_cast<double>(r.stageTicks[st]) * microsecondsPerTick * 1000.0, 1);
+                    if (args.isNotEmpty())
+                        addEvent("{\"name\":\"stages (ns)\",\"ph\":\"C\"" + common + ",\"args\":{" + args + "}}");
+                }
+            }
+
+            json << "\n]}\n";
+            return json;
+        }
+
+        // 構成ごとのステージ別の集計（ns/sample は process() に渡したサンプル数あたり、
+        // % は process() 全体の時間に対する割合。"other" は process() のうちどのステージにも入らない時間）
+        juce::String toSummaryTable() const
+        {
+            const double nanosecondsPerTick = 1.0e9 / ticksPerSecond();
+            juce::String text;
+
+            for (const auto& section : sections)
+            {
+                std::uint64_t ticks[numStages] = {};
+                std::uint64_t calls[numStages] = {};
+                std::uint64_t processStageTicks = 0;   // process() のスレッドで測ったステージの合計
+                juce::int64 samples = 0;
+
+                for (const auto& block : section.blocks)
+                {
+                    const auto& r = block.record;
+                    const int root = static_cast<int>(r.root);
+                    ticks[root] += r.end - r.start;
+                    ++calls[root];
+                    if (r.root == Stage::Process)
+                        samples += r.numSamples;
+
+                    for (int st = 0; st < numStages; ++st)
+                    {
+                        ticks[st] += r.stageTicks[st];
+                        calls[st] += r.stageCalls[st];
+                        if (r.root == Stage::Process)
+                            processStageTicks += r.stageTicks[st];
+                    }
+                }
+
+                text << section.label << "\n";
+                for (const auto& counter : section.counters)
+                    text << "  " << counter.name << ": " << juce::String(counter.value, 2) << "\n";
+                if (section.dropped > 0)
+                    text << "  (" << section.dropped << " blocks dropped - collect more often)\n";
+
+                text << "  " << juce::String("stage").paddedRight(' ', 18) << juce::String("calls").paddedLeft(' ', 10)
+                     << juce::String("total ms").paddedLeft(' ', 12) << juce::String("% process").paddedLeft(' ', 11)
+                     << juce::String("ns/sample").paddedLeft(' ', 11) << "\n";
+
+                const double processTicks = static_cast<double>(ticks[static_cast<int>(Stage::Process)]);
+                auto addRow = [&](const juce::String& name, double rowTicks, std::uint64_t rowCalls)
+                {
+                    const double ns = rowTicks * nanosecondsPerTick;
+                    text << "  " << name.paddedRight(' ', 18) << juce::String(static_cast<juce::int64>(rowCalls)).paddedLeft(' ', 10)
+                         << juce::String(ns * 1.0e-6, 3).paddedLeft(' ', 12)
+                         << juce::String(processTicks > 0.0 ? 100.0 * rowTicks / processTicks : 0.0, 1).paddedLeft(' ', 11)
+                         << juce::String(samples > 0 ? ns / static_cast<double>(samples) : 0.0, 2).paddedLeft(' ', 11) << "\n";
+                };
+
+                for (int st = 0; st < numStages; ++st)
+                    if (calls[st] > 0)
+                        addRow(getStageName(static_cast<Stage>(st)), static_cast<double>(ticks[st]), calls[st]);
+                if (calls[static_cast<int>(Stage::Process)] > 0)
+                    addRow("other", std::max(0.0, processTicks - static_cast<double>(processStageTicks)), 0);
+                text << "\n";
+            }
+            return text;
+        }
+
+    private:
+        struct Block
+        {
+            int thread;
+            BlockRecord record;
+        };
+
+        struct Counter
+        {
+            juce::String name;
+            double value;
+        };
+
+        struct Section
+        {
+            juce::String label;
+            std::vector<Block> blocks;
+            std::vector<Counter> counters;
+            int dropped = 0;
+        };
+
+        std::vector<Section> sections;
+        std::uint64_t firstTick = 0;
+    };
+}
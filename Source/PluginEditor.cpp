@@ -13,7 +13,8 @@ DomeLiveSimulatorAudioProcessorEditor::DomeLiveSimulatorAudioProcessorEditor(
     DomeLiveSimulatorAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
-    // ウィンドウサイズ
+    // ウィンドウサイズ（背景はすべて塗るので、後ろのコンポーネントは描かなくてよい）
+    setOpaque(true);
     setSize(400, 500);
 
     // カスタムLook and Feelを設定
@@ -74,18 +75,167 @@ DomeLiveSimulatorAudioProcessorEditor::DomeLiveSimulatorAudioProcessorEditor(
     // プリセットパラメータにアタッチ
     presetAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.getAPVTS(), "preset", presetSelector);
+
+    // 品質選択（プリセットの下）と、処理が重いときに自動で下げるトグル
+    qualitySelector.addItem("Eco", 1);
+    qualitySelector.addItem("Standard", 2);
+    qualitySelector.addItem("High", 3);
+    qualitySelector.setSelectedId(2);
+    qualitySelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff2a2a4a));
+    qualitySelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xff00d4ff));
+    qualitySelector.setColour(juce::ComboBox::outlineColourId, juce::Colour(0xff00d4ff).withAlpha(0.5f));
+    addAndMakeVisible(qualitySelector);
+
+    governorButton.setColour(juce::ToggleButton::textColourId, juce::Colour(0xffaaaaaa));
+    governorButton.setColour(juce::ToggleButton::tickColourId, juce::Colour(0xff00d4ff));
+    addAndMakeVisible(governorButton);
+
+    qualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "quality", qualitySelector);
+    governorAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.getAPVTS(), "qualityGovernor", governorButton);
+
+    // エンジンラベル
+    engineLabel.setText("ENGINE", juce::dontSendNotification);
+    engineLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    engineLabel.setColour(juce::Label::textColourId, juce::Colour(0xffaaaaaa));
+    engineLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(engineLabel);
+
+    // エンジン選択コンボボックス
+    engineSelector.addItem("Classic", 1);
+    engineSelector.addItem("FDN 8", 2);
+    engineSelector.addItem("FDN 16", 3);
+    engineSelector.addItem("Convolution", 4);
+    engineSelector.setSelectedId(1);
+    engineSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff2a2a4a));
+    engineSelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xff00d4ff));
+    engineSelector.setColour(juce::ComboBox::outlineColourId, juce::Colour(0xff00d4ff).withAlpha(0.5f));
+    addAndMakeVisible(engineSelector);
+
+    // エンジンパラメータにアタッチ
+    engineAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "engine", engineSelector);
+
+    // IR 読み込みボタン（読み込み済みならファイル名を表示）
+    loadIRButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xff2a2a4a));
+    updateImpulseResponseButton();
+    loadIRButton.onClick = [this]()
+    {
+        irChooser = std::make_unique<juce::FileChooser>("Load Impulse Response", juce::File(),
+                                                        "*.wav;*.aif;*.aiff;*.flac");
+        irChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                               [this](const juce::FileChooser& chooser)
+                               {
+                                   const auto file = chooser.getResult();
+                                   if (file.existsAsFile() && audioProcessor.loadImpulseResponse(file))
+                                       updateImpulseResponseButton();
+                               });
+    };
+    addAndMakeVisible(loadIRButton);
+
+    // レベルメーター
+    addAndMakeVisible(inputMeter);
+    addAndMakeVisible(tankMeter);
+    addAndMakeVisible(wetMeter);
+    addAndMakeVisible(outputMeter);
+    startTimerHz(30);
 }
 
 // デストラクタ
 DomeLiveSimulatorAudioProcessorEditor::~DomeLiveSimulatorAudioProcessorEditor()
 {
+    stopTimer();
     setLookAndFeel(nullptr);
 }
 
 //==============================================================================
-// 描画
+// メーターの更新
+void DomeLiveSimulatorAudioProcessorEditor::timerCallback()
+{
+    // 前回からたまった分をまとめる（ピークは最大、RMS とタンクのエネルギーは平均）
+    LevelMeter::Frame frames[32];
+    LevelMeter::Frame merged;
+    float inputMeanSquare = 0.0f, wetMeanSquare = 0.0f, outputMeanSquare = 0.0f;
+    int total = 0;
+
+    auto& fifo = audioProcessor.getMeterFifo();
+    while (const int count = fifo.pop(frames, 32))
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const auto& f = frames[i];
+            merged.input.peak = std::max(merged.input.peak, f.input.peak);
+            merged.wet.peak = std::max(merged.wet.peak, f.wet.peak);
+            merged.output.peak = std::max(merged.output.peak, f.output.peak);
+            inputMeanSquare += f.input.rms * f.input.rms;
+            wetMeanSquare += f.wet.rms * f.wet.rms;
+            outputMeanSquare += f.output.rms * f.output.rms;
+            merged.tankEnergy += f.tankEnergy;
+        }
+        total += count;
+    }
+
+    // 止まっているとき（処理されていない）は 0 のまま落としていく
+    if (total > 0)
+    {
+        const float scale = 1.0f / static_cast<float>(total);
+        merged.input.rms = std::sqrt(inputMeanSquare * scale);
+        merged.wet.rms = std::sqrt(wetMeanSquare * scale);
+        merged.output.rms = std::sqrt(outputMeanSquare * scale);
+        merged.tankEnergy *= scale;
+    }
+
+    auto toDb = [](float gain) { return juce::Decibels::gainToDecibels(gain, -100.0f); };
+    inputMeter.setLevel(toDb(merged.input.peak), toDb(merged.input.rms));
+    wetMeter.setLevel(toDb(merged.wet.peak), toDb(merged.wet.rms));
+    outputMeter.setLevel(toDb(merged.output.peak), toDb(merged.output.rms));
+
+    // タンクはエネルギー（二乗平均）なので 10 log10
+    const float tankDb = merged.tankEnergy > 0.0f ? 10.0f * std::log10(merged.tankEnergy) : -100.0f;
+    tankMeter.setLevel(tankDb, tankDb);
+
+    // ホストがステートを復元した後も表示を合わせる
+    updateImpulseResponseButton();
+}
+
+void DomeLiveSimulatorAudioProcessorEditor::updateImpulseResponseButton()
+{
+    const auto irFile = audioProcessor.getImpulseResponseFile();
+    const bool missing = audioProcessor.isImpulseResponseMissing();
+
+    juce::String text("LOAD IR");
+    if (missing)
+        text = irFile == juce::File() ? juce::String("IR MISSING") : "IR MISSING: " + irFile.getFileName();
+    else if (irFile != juce::File())
+        text = irFile.getFileName();
+
+    loadIRButton.setButtonText(text);
+    loadIRButton.setColour(juce::TextButton::textColourOffId, juce::Colour(missing ? 0xffff00ff : 0xff00d4ff));
+}
+
+//==============================================================================
+// 描画（背景はキャッシュした画像を貼るだけ。ノブとメーターは自分の範囲だけ描き直す）
 void DomeLiveSimulatorAudioProcessorEditor::paint(juce::Graphics& g)
 {
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (backgroundCache.isNull() || backgroundScale != scale)
+        renderBackground(scale);
+
+    g.drawImage(backgroundCache, getLocalBounds().toFloat());
+}
+
+// 背景を画像に描く（サイズか表示倍率が変わったときだけ）
+void DomeLiveSimulatorAudioProcessorEditor::renderBackground(float scale)
+{
+    backgroundScale = scale;
+    backgroundCache = juce::Image(juce::Image::RGB,
+                                  juce::jmax(1, juce::roundToInt((float)getWidth() * scale)),
+                                  juce::jmax(1, juce::roundToInt((float)getHeight() * scale)), false);
+
+    juce::Graphics g(backgroundCache);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
     // 背景グラデーション
     juce::ColourGradient backgroundGradient(
         juce::Colour(0xff0a0a1a), 0, 0,
@@ -120,6 +270,8 @@ void DomeLiveSimulatorAudioProcessorEditor::paint(juce::Graphics& g)
 // コンポーネントのレイアウト
 void DomeLiveSimulatorAudioProcessorEditor::resized()
 {
+    backgroundCache = {};   // 次の paint() で描き直す
+
     auto bounds = getLocalBounds();
     
     // 中央にノブを配置
@@ -128,12 +280,26 @@ void DomeLiveSimulatorAudioProcessorEditor::resized()
     knobArea.setY(90);
     domeKnob.setBounds(knobArea);
 
+    // メーター（ノブの左右に2本ずつ、下の 16px は名前）
+    const int meterWidth = 20;
+    const int meterHeight = knobSize + 16;
+    inputMeter.setBounds(20, knobArea.getY(), meterWidth, meterHeight);
+    tankMeter.setBounds(48, knobArea.getY(), meterWidth, meterHeight);
+    wetMeter.setBounds(getWidth() - 48 - meterWidth, knobArea.getY(), meterWidth, meterHeight);
+    outputMeter.setBounds(getWidth() - 20 - meterWidth, knobArea.getY(), meterWidth, meterHeight);
+
     // ノブの下にラベル
     domeLabel.setBounds(bounds.withY(knobArea.getBottom()).withHeight(35));
     valueLabel.setBounds(bounds.withY(knobArea.getBottom() + 30).withHeight(25));
 
-    // プリセットセレクター（下部に配置）
+    // プリセット・エンジンセレクター（下部に左右に並べる）
     auto presetY = knobArea.getBottom() + 75;
-    presetLabel.setBounds((getWidth() - 200) / 2, presetY, 200, 20);
-    presetSelector.setBounds((getWidth() - 150) / 2, presetY + 22, 150, 30);
+    auto columnWidth = getWidth() / 2;
+    presetLabel.setBounds(0, presetY, columnWidth, 20);
+    presetSelector.setBounds((columnWidth - 150) / 2, presetY + 22, 150, 30);
+    qualitySelector.setBounds((columnWidth - 150) / 2, presetY + 57, 92, 22);
+    governorButton.setBounds((columnWidth - 150) / 2 + 96, presetY + 57, 54, 22);
+    engineLabel.setBounds(columnWidth, presetY, columnWidth, 20);
+    engineSelector.setBounds(columnWidth + (columnWidth - 150) / 2, presetY + 22, 150, 30);
+    loadIRButton.setBounds(columnWidth + (columnWidth - 150) / 2, presetY + 57, 150, 22);
 }
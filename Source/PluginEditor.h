@@ -29,31 +29,18 @@ public:
                           float sliderPos, float rotaryStartAngle, float rotaryEndAngle,
                           juce::Slider& slider) override
     {
+        juce::ignoreUnused(slider);
+
         auto radius = (float)juce::jmin(width / 2, height / 2) - 10.0f;
         auto centreX = (float)x + (float)width * 0.5f;
         auto centreY = (float)y + (float)height * 0.5f;
-        auto rx = centreX - radius;
-        auto ry = centreY - radius;
-        auto rw = radius * 2.0f;
         auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
 
-        // 外側のリング（グラデーション）
-        juce::ColourGradient gradient(
-            juce::Colour(0xff0a0a1a), centreX, centreY - radius,
-            juce::Colour(0xff1a1a3a), centreX, centreY + radius, false
-        );
-        g.setGradientFill(gradient);
-        g.fillEllipse(rx, ry, rw, rw);
-
-        // 内側の円
-        auto innerRadius = radius * 0.75f;
-        juce::ColourGradient innerGradient(
-            juce::Colour(0xff2a2a4a), centreX, centreY - innerRadius,
-            juce::Colour(0xff1a1a2e), centreX, centreY + innerRadius, false
-        );
-        g.setGradientFill(innerGradient);
-        g.fillEllipse(centreX - innerRadius, centreY - innerRadius, 
-                      innerRadius * 2, innerRadius * 2);
+        // 動かない部分（外側のリング・内側の円）はサイズと表示倍率が変わったときだけ描き直す
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (knobBase.isNull() || knobBaseWidth != width || knobBaseHeight != height || knobBaseScale != scale)
+            renderKnobBase(width, height, scale);
+        g.drawImage(knobBase, juce::Rectangle<float>((float)x, (float)y, (float)width, (float)height));
 
         // アーク（値の表示）
         juce::Path arc;
@@ -83,11 +70,132 @@ public:
         g.setColour(juce::Colour(0xff00d4ff));
         g.fillEllipse(centreX - 8, centreY - 8, 16, 16);
     }
+
+private:
+    // ノブの土台を width x height（表示倍率 scale）の画像に描く
+    void renderKnobBase(int width, int height, float scale)
+    {
+        knobBaseWidth = width;
+        knobBaseHeight = height;
+        knobBaseScale = scale;
+        knobBase = juce::Image(juce::Image::ARGB,
+                               juce::jmax(1, juce::roundToInt((float)width * scale)),
+                               juce::jmax(1, juce::roundToInt((float)height * scale)), true);
+
+        juce::Graphics g(knobBase);
+        g.addTransform(juce::AffineTransform::scale(scale));
+
+        auto radius = (float)juce::jmin(width / 2, height / 2) - 10.0f;
+        auto centreX = (float)width * 0.5f;
+        auto centreY = (float)height * 0.5f;
+        auto rx = centreX - radius;
+        auto ry = centreY - radius;
+        auto rw = radius * 2.0f;
+
+        // 外側のリング（グラデーション）
+        juce::ColourGradient gradient(
+            juce::Colour(0xff0a0a1a), centreX, centreY - radius,
+            juce::Colour(0xff1a1a3a), centreX, centreY + radius, false
+        );
+        g.setGradientFill(gradient);
+        g.fillEllipse(rx, ry, rw, rw);
+
+        // 内側の円
+        auto innerRadius = radius * 0.75f;
+        juce::ColourGradient innerGradient(
+            juce::Colour(0xff2a2a4a), centreX, centreY - innerRadius,
+            juce::Colour(0xff1a1a2e), centreX, centreY + innerRadius, false
+        );
+        g.setGradientFill(innerGradient);
+        g.fillEllipse(centreX - innerRadius, centreY - innerRadius, 
+                      innerRadius * 2, innerRadius * 2);
+    }
+
+    juce::Image knobBase;
+    int knobBaseWidth = 0;
+    int knobBaseHeight = 0;
+    float knobBaseScale = 0.0f;
+};
+
+//==============================================================================
+// 縦長のレベルメーター（-60〜0dB、RMS をバー、ピークを線で表示）
+class DomeMeter : public juce::Component
+{
+public:
+    explicit DomeMeter(const juce::String& meterName) : name(meterName) {}
+
+    // タイマーから呼ぶ。上がるときはすぐ、下がるときは1回あたり releaseDb ずつ落とす
+    void setLevel(float peakDb, float rmsDb)
+    {
+        constexpr float releaseDb = 0.8f;   // 30Hz で約 24dB/秒
+        const float newPeak = std::max({ peakDb, displayedPeak - releaseDb, minimumDb });
+        const float newRms = std::max({ rmsDb, displayedRms - releaseDb, minimumDb });
+        if (newPeak == displayedPeak && newRms == displayedRms)
+            return;
+
+        // 変わった範囲（前と今のバーの先端・ピークの線を含む帯）だけ描き直す
+        const auto area = getBarArea();
+        const float top = std::min({ levelToY(displayedPeak, area), levelToY(newPeak, area),
+                                     levelToY(displayedRms, area), levelToY(newRms, area) });
+        const float bottom = std::max({ levelToY(displayedPeak, area), levelToY(newPeak, area),
+                                        levelToY(displayedRms, area), levelToY(newRms, area) });
+        displayedPeak = newPeak;
+        displayedRms = newRms;
+        repaint(area.withTop(top - 2.0f).withBottom(bottom + 2.0f).getSmallestIntegerContainer());
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        const auto bounds = getBarArea();
+        const auto labelArea = getLocalBounds().toFloat().withTop(bounds.getBottom());
+
+        // 背景
+        g.setColour(juce::Colour(0xff1a1a2e));
+        g.fillRoundedRectangle(bounds, 3.0f);
+
+        // RMS のバー（下がシアン、上がマゼンタ）
+        const float rmsY = levelToY(displayedRms, bounds);
+        juce::ColourGradient barGradient(
+            juce::Colour(0xff00d4ff), 0, bounds.getBottom(),
+            juce::Colour(0xffff00ff), 0, bounds.getY(), false
+        );
+        g.setGradientFill(barGradient);
+        g.fillRect(bounds.withTop(rmsY));
+
+        // ピークの線
+        g.setColour(juce::Colour(0xffffffff));
+        g.fillRect(bounds.getX(), levelToY(displayedPeak, bounds) - 1.0f, bounds.getWidth(), 2.0f);
+
+        // 名前
+        g.setFont(juce::Font(10.0f, juce::Font::bold));
+        g.setColour(juce::Colour(0xffaaaaaa));
+        g.drawText(name, labelArea.expanded(8.0f, 0.0f), juce::Justification::centred, false);
+    }
+
+private:
+    static constexpr float minimumDb = -60.0f;
+
+    // 下の 16px は名前
+    juce::Rectangle<float> getBarArea() const
+    {
+        return getLocalBounds().toFloat().withTrimmedBottom(16.0f);
+    }
+
+    static float levelToY(float db, juce::Rectangle<float> area)
+    {
+        const float proportion = juce::jlimit(0.0f, 1.0f, 1.0f - db / minimumDb);
+        return area.getBottom() - proportion * area.getHeight();
+    }
+
+    juce::String name;
+    float displayedPeak = minimumDb;
+    float displayedRms = minimumDb;
 };
 
 //==============================================================================
 // プラグインエディター（メインUI）
-class DomeLiveSimulatorAudioProcessorEditor : public juce::AudioProcessorEditor
+class DomeLiveSimulatorAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                              private juce::Timer
 {
 public:
     DomeLiveSimulatorAudioProcessorEditor(DomeLiveSimulatorAudioProcessor&);
@@ -97,11 +205,24 @@ public:
     void resized() override;
 
 private:
+    // プロセッサーのメーター FIFO から取り出して表示し、IR の状態を反映する（30Hz）
+    void timerCallback() override;
+
+    // IR 読み込みボタンの表示（読み込み済みならファイル名、復元した IR が見つからなければ警告）
+    void updateImpulseResponseButton();
+
+    // 動かない背景（グラデーション・タイトル・装飾ライン・フッター）を画像に描く
+    void renderBackground(float scale);
+
     DomeLiveSimulatorAudioProcessor& audioProcessor;
 
     // カスタムLook and Feel
     DomeLookAndFeel domeLookAndFeel;
 
+    // 背景のキャッシュ（サイズか表示倍率が変わったら作り直す）
+    juce::Image backgroundCache;
+    float backgroundScale = 0.0f;
+
     // ワンノブ
     juce::Slider domeKnob;
     juce::Label domeLabel;
@@ -111,9 +232,30 @@ private:
     juce::ComboBox presetSelector;
     juce::Label presetLabel;
 
+    // 品質（Classic のコム・オールパスの本数）と自動で下げるかどうか
+    juce::ComboBox qualitySelector;
+    juce::ToggleButton governorButton { "AUTO" };
+
+    // 後期残響エンジン選択
+    juce::ComboBox engineSelector;
+    juce::Label engineLabel;
+
+    // 畳み込みエンジン用の IR 読み込み
+    juce::TextButton loadIRButton;
+    std::unique_ptr<juce::FileChooser> irChooser;
+
+    // レベルメーター（ノブの左に入力・タンク、右に wet・出力）
+    DomeMeter inputMeter { "IN" };
+    DomeMeter tankMeter { "TANK" };
+    DomeMeter wetMeter { "WET" };
+    DomeMeter outputMeter { "OUT" };
+
     // パラメータアタッチメント（UIとパラメータを同期）
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> domeKnobAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> presetAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> engineAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> qualityAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> governorAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DomeLiveSimulatorAudioProcessorEditor)
 };
@@ -7,6 +7,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeSafety.h"
 
 //==============================================================================
 // コンストラクタ
@@ -16,6 +17,16 @@ DomeLiveSimulatorAudioProcessor::DomeLiveSimulatorAudioProcessor()
                      .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
       apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    domeAmountParameter = apvts.getRawParameterValue("domeAmount");
+    presetParameter = apvts.getRawParameterValue("preset");
+    engineParameter = apvts.getRawParameterValue("engine");
+    qualityParameter = apvts.getRawParameterValue("quality");
+    governorParameter = apvts.getRawParameterValue("qualityGovernor");
+
+    // ステートに書くパラメータ（すべて APVTS の RangedAudioParameter）
+    for (auto* parameter : getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            stateParameters.add(ranged);
 }
 
 // デストラクタ
@@ -47,6 +58,29 @@ DomeLiveSimulatorAudioProcessor::createParameterLayout()
         0  // デフォルト: Arena
     ));
 
+    // 後期残響エンジン選択パラメータ
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("engine", 1),
+        "Engine",
+        juce::StringArray{ "Classic", "FDN 8", "FDN 16", "Convolution" },
+        0  // デフォルト: Classic（従来の音）
+    ));
+
+    // 品質（Classic エンジンのコム・オールパスの本数）
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("quality", 1),
+        "Quality",
+        juce::StringArray{ "Eco", "Standard", "High" },
+        1  // デフォルト: Standard（従来の音）
+    ));
+
+    // 処理が重いときに品質を自動で下げる
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("qualityGovernor", 1),
+        "Quality Governor",
+        false
+    ));
+
     return { params.begin(), params.end() };
 }
 
@@ -54,18 +88,88 @@ DomeLiveSimulatorAudioProcessor::createParameterLayout()
 // オーディオ処理の準備
 void DomeLiveSimulatorAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // リバーブを初期化
-    domeReverb.prepare(sampleRate, samplesPerBlock);
-    
-    // 初期パラメータを設定
-    float domeAmount = apvts.getRawParameterValue("domeAmount")->load();
-    domeReverb.setDomeAmount(domeAmount);
+    inputMeter.reset();
+    outputMeter.reset();
+    qualityGovernor.prepare(sampleRate, DomeReverb<float>::qualityFadeSeconds);
+
+    // 使わないほうのリバーブは IR を外してワーカースレッドを止めておく
+    if (getProcessingPrecision() == doublePrecision)
+    {
+        floatReverb.setImpulseResponse(nullptr);
+        floatReverb.stopThreads();
+    }
+    else
+    {
+        doubleReverb.setImpulseResponse(nullptr);
+        doubleReverb.stopThreads();
+    }
+
+    withActiveReverb([&](auto& reverb)
+    {
+        // リバーブを初期化（出力バスのチャンネル配置に合わせてペアを作り、入力の配置でカーネルを選ぶ）
+        // オフラインレンダリングでは畳み込みのテールもオーディオスレッドで計算する
+        reverb.setNonRealtime(isNonRealtime());
+        reverb.prepare(sampleRate, samplesPerBlock, getChannelLayoutOfBus(false, 0), getChannelLayoutOfBus(true, 0));
+
+        // プリセットを反映（処理精度が切り替わったときは、使っていなかったほうにも）
+        currentPresetIndex = static_cast<int>(presetParameter->load());
+        reverb.setPreset(static_cast<DomePreset>(currentPresetIndex));
+
+        // 内部レートが変わったら IR を分割し直す
+        if (impulseResponseSamples.getNumSamples() > 0
+            && (convolutionIR == nullptr || convolutionIR->getSampleRate() != reverb.getInternalSampleRate()))
+            updateConvolutionIR();
+        else if (reverb.getImpulseResponse() != convolutionIR)
+            reverb.setImpulseResponse(convolutionIR);
+        reverb.setEngine(static_cast<ReverbEngine>(static_cast<int>(engineParameter->load())));
+        reverb.setQuality(static_cast<ReverbQuality>(static_cast<int>(qualityParameter->load())));
+
+        // 初期パラメータを設定（prepare 直後の値は最初のブロックで即座に反映される）
+        lastDomeAmount = domeAmountParameter->load();
+        reverb.setDomeAmount(lastDomeAmount);
+    });
+}
+
+double DomeLiveSimulatorAudioProcessor::getTailLengthSeconds() const
+{
+    return withActiveReverb([](const auto& reverb) { return reverb.getTailLengthSeconds(); });
 }
 
 // リソース解放
 void DomeLiveSimulatorAudioProcessor::releaseResources()
 {
-    domeReverb.clear();
+    withActiveReverb([](auto& reverb) { reverb.clear(); });
+}
+
+//==============================================================================
+// チャンネル配置の対応
+bool DomeLiveSimulatorAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
+{
+    const auto& input = layouts.getMainInputChannelSet();
+    const auto& output = layouts.getMainOutputChannelSet();
+
+    // モノラル入力 → ステレオ出力（1つの入力から L/R の残響を作る）
+    if (input == juce::AudioChannelSet::mono() && output == juce::AudioChannelSet::stereo())
+        return true;
+
+    // それ以外は入力と出力が同じ配置のみ（チャンネルごとにリバーブを掛けて返す）
+    if (input != output)
+        return false;
+
+    const juce::AudioChannelSet supported[] = {
+        juce::AudioChannelSet::mono(),
+        juce::AudioChannelSet::stereo(),
+        juce::AudioChannelSet::create5point0(),
+        juce::AudioChannelSet::create5point1(),
+        juce::AudioChannelSet::create7point0(),
+        juce::AudioChannelSet::create7point1(),
+        juce::AudioChannelSet::create7point0point2(),
+        juce::AudioChannelSet::create7point1point2(),
+        juce::AudioChannelSet::create7point0point4(),
+        juce::AudioChannelSet::create7point1point4()
+    };
+
+    return std::find(std::begin(supported), std::end(supported), output) != std::end(supported);
 }
 
 //==============================================================================
@@ -74,47 +178,259 @@ void DomeLiveSimulatorAudioProcessor::processBlock(juce::AudioBuffer<float>& buf
                                                     juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
+    processReverb(buffer, floatReverb);
+}
+
+// 倍精度のホスト
+void DomeLiveSimulatorAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+                                                    juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processReverb(buffer, doubleReverb);
+}
+
+template <typename SampleType>
+void DomeLiveSimulatorAudioProcessor::processReverb(juce::AudioBuffer<SampleType>& buffer,
+                                                    DomeReverb<SampleType>& reverb)
+{
+    // チェック用ビルドではこの関数の間の確保・ロック・システムコールを違反として数える
+    RealtimeSafety::ScopedRealtimeSection realtimeSection;
 
     // 出力をクリア（ノイズ防止）
     juce::ScopedNoDenormals noDenormals;
     
-    // 入力チャンネル数より出力チャンネル数が多い場合、余分をクリア
-    for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+    // モノラル入力 → ステレオ出力は dry を両方に置く（wet は DomeReverb が入力1つから L/R に作る）。
+    // それ以外で入力チャンネル数より出力チャンネル数が多い場合、余分をクリア
+    if (getTotalNumInputChannels() == 1 && getTotalNumOutputChannels() == 2)
+        buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
+    else
+        for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
+            buffer.clear(i, 0, buffer.getNumSamples());
 
-    // プリセットを取得してリバーブに設定
-    int presetIndex = static_cast<int>(apvts.getRawParameterValue("preset")->load());
+    // プリセットを取得してリバーブに設定（設計済みの値に切り替え、初期反射はクロスフェードする）
+    int presetIndex = static_cast<int>(presetParameter->load());
     if (presetIndex != currentPresetIndex)
     {
         currentPresetIndex = presetIndex;
-        domeReverb.setPreset(static_cast<DomePreset>(presetIndex));
+        reverb.setPreset(static_cast<DomePreset>(presetIndex));
+        lastDomeAmount = -1.0f;  // ノブの値を改めて反映させる
+    }
+
+    // 後期残響エンジン（切り替えたときだけ）
+    reverb.setEngine(static_cast<ReverbEngine>(static_cast<int>(engineParameter->load())));
+
+    // 品質（ガバナーが有効なら処理時間を見て下げる。オフラインレンダリングでは選んだ品質のまま）
+    // 切り替えると前の品質のタンクは DomeReverb の中でフェードアウトするので、wet は途切れない
+    const bool governed = governorParameter->load() >= 0.5f && ! isNonRealtime();
+    if (! governed)
+        qualityGovernor.reset();
+    const int selectedQuality = static_cast<int>(qualityParameter->load());
+    qualityGovernor.setAvailableSteps(selectedQuality);
+    reverb.setQuality(static_cast<ReverbQuality>(std::max(0, selectedQuality - qualityGovernor.getStepsDown())));
+
+    // ノブが動いたときだけリバーブに設定（変化は DomeReverb 内で滑らかに補間される）
+    float domeAmount = domeAmountParameter->load();
+    if (domeAmount != lastDomeAmount)
+    {
+        lastDomeAmount = domeAmount;
+        reverb.setDomeAmount(domeAmount);
     }
 
-    // パラメータを取得してリバーブに設定
-    float domeAmount = apvts.getRawParameterValue("domeAmount")->load();
-    domeReverb.setDomeAmount(domeAmount);
+    // リバーブ処理（前後でメーター用のレベルを測る）
+    const int numSamples = buffer.getNumSamples();
+    for (int ch = 0; ch < getTotalNumInputChannels(); ++ch)
+        inputMeter.add(buffer.getReadPointer(ch), numSamples);
+
+    const auto startTicks = governed ? juce::Time::getHighResolutionTicks() : 0;
+    reverb.process(buffer);
+    if (governed)
+        qualityGovernor.addMeasurement(
+            juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks), numSamples);
+
+    for (int ch = 0; ch < getTotalNumOutputChannels(); ++ch)
+        outputMeter.add(buffer.getReadPointer(ch), numSamples);
+    publishMeters(reverb);
+}
+
+template <typename SampleType>
+void DomeLiveSimulatorAudioProcessor::publishMeters(DomeReverb<SampleType>& reverb)
+{
+    LevelMeter::Frame frame;
+    frame.input = inputMeter.getLevel();
+    frame.wet = reverb.getWetMeter().getLevel();
+    frame.output = outputMeter.getLevel();
+    frame.tankEnergy = reverb.getTankMeter().getMeanSquare();
+
+    if (! meterFifo.push(frame))
+        return;
 
-    // リバーブ処理
-    domeReverb.process(buffer);
+    inputMeter.reset();
+    outputMeter.reset();
+    reverb.resetMeters();
 }
 
 //==============================================================================
 // ステート情報の保存（DAWがプロジェクトを保存するとき）
+//
+// バイナリ形式（リトルエンディアン）:
+//   int32 "DLST" / int32 バージョン / 圧縮 int パラメータ数 /
+//   パラメータごとに ID（UTF-8、0 終端）と値（float、範囲の実際の値）/ IR のパス（UTF-8、0 終端）
+// 以前の XML（copyXmlToBinary）のステートも読める
+namespace
+{
+    constexpr int stateMagic = 0x54534c44;   // "DLST"
+    constexpr int stateVersion = 1;
+}
+
 void DomeLiveSimulatorAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(stateMagic);
+    stream.writeInt(stateVersion);
+
+    stream.writeCompressedInt(stateParameters.size());
+    for (auto* parameter : stateParameters)
+    {
+        stream.writeString(parameter->getParameterID());
+        stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+    }
+
+    stream.writeString(apvts.state.getProperty("impulseResponse").toString());
 }
 
 // ステート情報の復元（DAWがプロジェクトを開くとき）
 void DomeLiveSimulatorAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    if (xmlState != nullptr && xmlState->hasTagName(apvts.state.getType()))
+    const auto previousImpulseResponse = getImpulseResponseFile();
+
+    juce::MemoryInputStream stream(data, static_cast<size_t>(juce::jmax(0, sizeInBytes)), false);
+    if (sizeInBytes >= 8 && stream.readInt() == stateMagic)
+    {
+        if (! readBinaryState(stream))
+            return;
+    }
+    else
     {
+        // 以前の XML 形式
+        std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+        if (xmlState == nullptr || ! xmlState->hasTagName(apvts.state.getType()))
+            return;
+
         apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
     }
+
+    // 保存されていた IR を読み直す（同じファイルを読み込み済みなら読み直さない）
+    // パスが空・ファイルがない・読めないときは前の IR を残さず外す。パスはステートに残し
+    // （ファイルを戻してから開き直せば読める）、見つからないことをエディターに伝える
+    const juce::File file = getImpulseResponseFile();
+    const bool alreadyLoaded = file == previousImpulseResponse && impulseResponseSamples.getNumSamples() > 0;
+    const bool loaded = file.existsAsFile() && (alreadyLoaded || loadImpulseResponse(file));
+
+    if (! loaded)
+        clearImpulseResponse();
+
+    impulseResponseMissing.store(! loaded && apvts.state.getProperty("impulseResponse").toString().isNotEmpty(),
+                                 std::memory_order_relaxed);
+}
+
+// バイナリのステートをパラメータに直接反映する（ValueTree は作り直さず、値が変わるものだけ設定する）
+// 知らない ID は読み飛ばし、ステートにないパラメータは今の値のまま
+bool DomeLiveSimulatorAudioProcessor::readBinaryState(juce::MemoryInputStream& stream)
+{
+    const int version = stream.readInt();
+    if (version < 1 || version > stateVersion)
+        return false;
+
+    const int numParameters = stream.readCompressedInt();
+    for (int i = 0; i < numParameters && ! stream.isExhausted(); ++i)
+    {
+        const auto id = stream.readString();
+        const float value = stream.readFloat();
+
+        for (auto* parameter : stateParameters)
+        {
+            if (parameter->getParameterID() == id)
+            {
+                const float normalised = parameter->convertTo0to1(value);
+                if (parameter->getValue() != normalised)
+                    parameter->setValueNotifyingHost(normalised);
+                break;
+            }
+        }
+    }
+
+    apvts.state.setProperty("impulseResponse", stream.readString(), nullptr);
+    return true;
+}
+
+//==============================================================================
+// 畳み込みエンジン用のインパルス応答
+bool DomeLiveSimulatorAudioProcessor::loadImpulseResponse(const juce::File& file)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return false;
+
+    // 長すぎるファイルは ConvolutionIR の上限で切られるので、その分だけ読む
+    const auto maxSamples = static_cast<juce::int64>(ConvolutionIR::maxLengthSeconds * reader->sampleRate);
+    const int numSamples = static_cast<int>(std::min(reader->lengthInSamples, maxSamples));
+    const int numChannels = static_cast<int>(std::min(reader->numChannels, 4u));
+
+    juce::AudioBuffer<float> samples(numChannels, numSamples);
+    reader->read(&samples, 0, numSamples, 0, true, true);
+
+    apvts.state.setProperty("impulseResponse", file.getFullPathName(), nullptr);
+    impulseResponseMissing.store(false, std::memory_order_relaxed);
+    setImpulseResponse(std::move(samples), reader->sampleRate);
+    return true;
+}
+
+void DomeLiveSimulatorAudioProcessor::setImpulseResponse(juce::AudioBuffer<float> impulseResponse,
+                                                         double sampleRate)
+{
+    impulseResponseSamples = std::move(impulseResponse);
+    impulseResponseSampleRate = sampleRate;
+
+    // prepareToPlay 前ならそこで分割する
+    if (getSampleRate() > 0.0)
+        updateConvolutionIR();
+}
+
+void DomeLiveSimulatorAudioProcessor::clearImpulseResponse()
+{
+    impulseResponseSamples.setSize(0, 0);
+    impulseResponseSampleRate = 0.0;
+    convolutionIR.reset();
+
+    // prepareToPlay 前ならリバーブはまだ IR を持っていない
+    if (getSampleRate() > 0.0)
+        updateConvolutionIR();
+}
+
+juce::File DomeLiveSimulatorAudioProcessor::getImpulseResponseFile() const
+{
+    const auto path = apvts.state.getProperty("impulseResponse").toString();
+    return juce::File::isAbsolutePath(path) ? juce::File(path) : juce::File();
+}
+
+void DomeLiveSimulatorAudioProcessor::updateConvolutionIR()
+{
+    // 分割・FFT は重いので処理を止める前に済ませ、差し替えの間だけ止める
+    // （IR は wet の経路の内部レートに合わせる）
+    withActiveReverb([this](auto& reverb)
+    {
+        auto newIR = ConvolutionIR::create(impulseResponseSamples, impulseResponseSampleRate,
+                                           reverb.getInternalSampleRate());
+
+        const bool wasSuspended = isSuspended();
+        suspendProcessing(true);
+        convolutionIR = std::move(newIR);
+        reverb.setImpulseResponse(convolutionIR);
+        suspendProcessing(wasSuspended);
+    });
 }
 
 //==============================================================================
@@ -128,12 +444,10 @@ juce::AudioProcessorEditor* DomeLiveSimulatorAudioProcessor::createEditor()
 // プリセット関連
 void DomeLiveSimulatorAudioProcessor::setCurrentProgram(int index)
 {
+    // リバーブには触らず、パラメータだけを更新する（process() と同時に走るメッセージスレッドから
+    // 係数を書き換えないため）。オーディオスレッドが次のブロックの頭で反映する
     if (index >= 0 && index < 4)
     {
-        currentPresetIndex = index;
-        domeReverb.setPreset(static_cast<DomePreset>(index));
-        
-        // パラメータも更新
         if (auto* param = apvts.getParameter("preset"))
             param->setValueNotifyingHost(static_cast<float>(index) / 3.0f);
     }
@@ -11,6 +11,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "DSP/DomeReverb.h"
+#include "DSP/QualityGovernor.h"
 
 class DomeLiveSimulatorAudioProcessor : public juce::AudioProcessor
 {
@@ -25,6 +26,14 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // 倍精度はホストのバッファのまま DomeReverb<double> で処理する（変換のコピーなし）
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    // 対応するチャンネル配置（モノラル / ステレオ / 5.x / 7.x / 7.x.2 / 7.x.4 は入出力が同じ、
+    // ほかにモノラル入力 → ステレオ出力）
+    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     //==========================================================================
     // プラグイン情報
@@ -32,12 +41,12 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 5.0; } // リバーブのテール
+    double getTailLengthSeconds() const override; // リバーブのテール（エンジン・ノブ・IR から求める）
     
     //==========================================================================
     // プログラム（プリセット）
     int getNumPrograms() override { return 4; }
-    int getCurrentProgram() override { return currentPresetIndex; }
+    int getCurrentProgram() override { return static_cast<int>(presetParameter->load()); }
     void setCurrentProgram(int index) override;
     const juce::String getProgramName(int index) override;
     void changeProgramName(int, const juce::String&) override {}
@@ -56,17 +65,97 @@ public:
     // パラメータ
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
+    //==========================================================================
+    // 畳み込みエンジン用のインパルス応答（メッセージスレッドから呼ぶ）
+    // WAV / AIFF などを読み込み、パスをステートに保存する。失敗したら false
+    bool loadImpulseResponse(const juce::File& file);
+
+    // 読み込み済みのサンプルを設定（1 / 2 / 4ch、sampleRate は IR の録音レート）
+    void setImpulseResponse(juce::AudioBuffer<float> impulseResponse, double sampleRate);
+
+    juce::File getImpulseResponseFile() const;
+
+    // 復元したステートの IR ファイルが見つからない・読めないとき true（IR は外し、パスはステートに残す）
+    bool isImpulseResponseMissing() const { return impulseResponseMissing.load(std::memory_order_relaxed); }
+
+    //==========================================================================
+    // レベルメーター（エディターがタイマーから取り出す。取り出すのは1か所だけ）
+    LevelMeter::FrameFifo& getMeterFifo() { return meterFifo; }
+
 private:
     // パラメータツリーを作成
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+    // 現在のサンプルレートで IR を分割してリバーブに渡す（処理を止めて差し替える）
+    void updateConvolutionIR();
+
+    // 読み込んだ IR を捨て、リバーブからも外す
+    void clearImpulseResponse();
+
+    // バイナリ形式のステート（先頭の識別子より後）を読んで反映する。読めない版なら false
+    bool readBinaryState(juce::MemoryInputStream& stream);
+
+    // processBlock の本体（float / double 共通）
+    template <typename SampleType>
+    void processReverb(juce::AudioBuffer<SampleType>& buffer, DomeReverb<SampleType>& reverb);
+
+    // このブロックまでの測定値を FIFO に入れる（満杯なら次のブロックに持ち越す）
+    template <typename SampleType>
+    void publishMeters(DomeReverb<SampleType>& reverb);
+
+    // ホストの処理精度に合ったほうのリバーブで fn(reverb) を呼ぶ
+    template <typename Function>
+    decltype(auto) withActiveReverb(Function&& fn)
+    {
+        if (getProcessingPrecision() == doublePrecision)
+            return fn(doubleReverb);
+        return fn(floatReverb);
+    }
+
+    template <typename Function>
+    decltype(auto) withActiveReverb(Function&& fn) const
+    {
+        if (getProcessingPrecision() == doublePrecision)
+            return fn(doubleReverb);
+        return fn(floatReverb);
+    }
+
     // オーディオパラメータ
     juce::AudioProcessorValueTreeState apvts;
 
-    // ドームリバーブ
-    DomeReverb domeReverb;
+    // パラメータ値へのポインタ（文字列検索を毎ブロック行わないようキャッシュ）
+    std::atomic<float>* domeAmountParameter = nullptr;
+    std::atomic<float>* presetParameter = nullptr;
+    std::atomic<float>* engineParameter = nullptr;
+    std::atomic<float>* qualityParameter = nullptr;
+    std::atomic<float>* governorParameter = nullptr;
+
+    // ステートに保存するパラメータ（getParameters() の順）
+    juce::Array<juce::RangedAudioParameter*> stateParameters;
+
+    // 前回リバーブに渡したノブの値（変化があったときだけ更新する）
+    float lastDomeAmount = -1.0f;
+
+    // ドームリバーブ（prepareToPlay で処理精度に合ったほうだけ準備する）
+    DomeReverb<float> floatReverb;
+    DomeReverb<double> doubleReverb;
+
+    // 処理時間を見て品質を下げるガバナー（オーディオスレッドだけが触る）
+    QualityGovernor qualityGovernor;
+
+    // 読み込んだインパルス応答（元のサンプルレートのまま）と、分割済みのもの
+    juce::AudioBuffer<float> impulseResponseSamples;
+    double impulseResponseSampleRate = 0.0;
+    std::shared_ptr<const ConvolutionIR> convolutionIR;
+    std::atomic<bool> impulseResponseMissing { false };   // エディターがタイマーから見る
+
+    // メーター（入力・出力はここで、wet とタンクは DomeReverb の中で測る）
+    LevelMeter::FrameFifo meterFifo;
+    LevelMeter::Accumulator inputMeter;
+    LevelMeter::Accumulator outputMeter;
     
-    // 現在のプリセットインデックス
+    // リバーブに適用済みのプリセット（prepareToPlay とオーディオスレッドだけが触る。
+    // ほかのスレッドからの切り替えは preset パラメータを通して、オーディオスレッドがブロックの頭で反映する）
     int currentPresetIndex = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DomeLiveSimulatorAudioProcessor)
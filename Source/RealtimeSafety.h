@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+    RealtimeSafety.h
+    オーディオスレッドのリアルタイム安全性チェック用の目印
+
+    processBlock の間だけ「リアルタイム区間」に入ったことをスレッドローカルに記録する。
+    チェック用ビルド（DOMELIVE_RT_SAFETY_CHECKS=1）では、
+    Tools/RealtimeCheck の差し替え関数（malloc / mutex / スリープ等）がこの目印を見て
+    区間内での呼び出しを違反として数える。
+    通常ビルドでは何もしない空のクラスになる。
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifndef DOMELIVE_RT_SAFETY_CHECKS
+ #define DOMELIVE_RT_SAFETY_CHECKS 0
+#endif
+
+namespace RealtimeSafety
+{
+#if DOMELIVE_RT_SAFETY_CHECKS
+    // 現在のスレッドがリアルタイム区間にいる深さ
+    inline thread_local int realtimeDepth = 0;
+
+    inline bool isInRealtimeSection() noexcept { return realtimeDepth > 0; }
+
+    // スコープの間リアルタイム区間とする
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept  { ++realtimeDepth; }
+        ~ScopedRealtimeSection() noexcept { --realtimeDepth; }
+    };
+#else
+    inline bool isInRealtimeSection() noexcept { return false; }
+
+    struct ScopedRealtimeSection { ScopedRealtimeSection() noexcept {} };
+#endif
+}
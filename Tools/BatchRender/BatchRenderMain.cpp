@@ -0,0 +1,369 @@
+/*
+  ==============================================================================
+    BatchRenderMain.cpp
+    WAV / AIFF のステムをまとめて DomeReverb に通すオフラインレンダラー（GUIなしのコンソールアプリ）
+
+    ファイルごとのジョブをキューに積み、CPU のコア数ぶんのワーカースレッドが順に取っていく。
+    DomeReverb はワーカーごとに1つ持ち、ジョブの間で使い回す（サンプルレートと
+    チャンネル数が変わったときだけ prepare し直し、それ以外は clear() だけ）。
+    入力は MemoryMappedAudioFormatReader でファイルをメモリにマップして読み
+    （対応していない形式は通常のリーダー）、ブロック用のバッファはワーカーごとに最初に確保する。
+    入力が終わったあとも、出力のピークがしきい値を下回るまで残響のテールを書き出す。
+    インスタンスの中では L/R を分けず（setParallelLanes(false)）、ファイル単位で並列にする。
+
+    使い方:
+      DomeBatchRender [--preset arena|stadium|hall|club] [--amount 0.6]
+                      [--engine classic|fdn8|fdn16] [--quality eco|standard|high]
+                      [--threads N] [--tail-threshold -90] [--max-tail 30] [--block 4096]
+                      [--output-dir 出力フォルダ] [--suffix _dome] [--format wav|aiff]
+                      ファイルまたはフォルダ ...
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DSP/DomeReverb.h"
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    //==========================================================================
+    // 設定とジョブ
+    struct RenderConfig
+    {
+        DomePreset preset = DomePreset::Arena;
+        float domeAmount = -1.0f;          // 負ならプリセットの値
+        ReverbEngine engine = ReverbEngine::Classic;
+        ReverbQuality quality = ReverbQuality::Standard;
+        int numThreads = 0;                // 0 なら CPU のコア数
+        float tailThresholdDb = -90.0f;    // テールを打ち切る出力のピーク
+        double maxTailSeconds = 30.0;
+        int blockSize = 4096;
+        juce::File outputDirectory;        // 空なら入力と同じフォルダ
+        juce::String suffix = "_dome";
+        juce::String format;               // 空なら入力と同じ形式
+        juce::Array<juce::File> inputs;
+    };
+
+    struct RenderResult
+    {
+        bool ok = false;
+        juce::String message;
+        juce::File output;
+        double inputSeconds = 0.0;
+        double tailSeconds = 0.0;
+        double renderSeconds = 0.0;
+    };
+
+    const char* presetNames[] = { "arena", "stadium", "hall", "club" };
+    const char* engineNames[] = { "classic", "fdn8", "fdn16" };
+    const char* qualityNames[] = { "eco", "standard", "high" };
+
+    int indexOf(const char* const* names, int count, const juce::String& name)
+    {
+        for (int i = 0; i < count; ++i)
+            if (name.equalsIgnoreCase(names[i]))
+                return i;
+        return -1;
+    }
+
+    //==========================================================================
+    // ファイルごとのジョブをキューから取って処理するワーカー
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker(const RenderConfig& c, juce::AudioFormatManager& formats,
+                     std::atomic<int>& next, juce::Array<RenderResult>& r)
+            : juce::Thread("DomeLive Batch Render"),
+              config(c), formatManager(formats), nextJob(next), results(r)
+        {
+            // ブロック用のバッファは最初に確保しておく（チャンネル数が増えたときだけ確保し直す）
+            block.setSize(2, config.blockSize);
+        }
+
+        ~RenderWorker() override { stopThread(1000); }
+
+        void run() override
+        {
+            juce::ScopedNoDenormals noDenormals;
+
+            for (;;)
+            {
+                const int job = nextJob.fetch_add(1);
+                if (job >= config.inputs.size() || threadShouldExit())
+                    break;
+
+                const auto start = juce::Time::getHighResolutionTicks();
+                auto& result = results.getReference(job);
+                result = render(config.inputs.getReference(job));
+                result.renderSeconds = juce::Time::highResolutionTicksToSeconds(
+                    juce::Time::getHighResolutionTicks() - start);
+            }
+        }
+
+    private:
+        RenderResult render(const juce::File& input)
+        {
+            RenderResult result;
+
+            auto* inputFormat = formatManager.findFormatForFileExtension(input.getFileExtension());
+            if (inputFormat == nullptr)
+            {
+                result.message = "unsupported file type";
+                return result;
+            }
+
+            // ファイル全体をメモリにマップして読む（マップできない形式は通常のリーダー）
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(inputFormat->createMemoryMappedReader(input));
+            if (mapped != nullptr && mapped->mapEntireFile())
+                reader = std::move(mapped);
+            else
+                reader.reset(formatManager.createReaderFor(input));
+
+            if (reader == nullptr)
+            {
+                result.message = "cannot read file";
+                return result;
+            }
+
+            const int numChannels = static_cast<int>(reader->numChannels);
+            const double sampleRate = reader->sampleRate;
+            if (numChannels < 1 || numChannels > DomeReverb<float>::maxLanes || sampleRate <= 0.0)
+            {
+                result.message = "unsupported channel count or sample rate";
+                return result;
+            }
+
+            auto* outputFormat = config.format.isNotEmpty()
+                                   ? formatManager.findFormatForFileExtension(config.format) : inputFormat;
+            const auto directory = config.outputDirectory == juce::File() ? input.getParentDirectory()
+                                                                          : config.outputDirectory;
+            result.output = directory.getChildFile(input.getFileNameWithoutExtension() + config.suffix)
+                                     .withFileExtension(outputFormat->getFileExtensions()[0]);
+
+            // FileOutputStream は既存のファイルに追記するので、先に消しておく
+            result.output.deleteFile();
+            std::unique_ptr<juce::OutputStream> stream(result.output.createOutputStream());
+            if (stream == nullptr)
+            {
+                result.message = "cannot create " + result.output.getFullPathName();
+                return result;
+            }
+
+            const int bitsPerSample = reader->usesFloatingPointData ? 32 : static_cast<int>(reader->bitsPerSample);
+            std::unique_ptr<juce::AudioFormatWriter> writer(
+                outputFormat->createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+                                              bitsPerSample, {}, 0));
+            if (writer == nullptr)
+            {
+                result.message = "cannot write this format";
+                return result;
+            }
+            stream.release();   // writer が持つ
+
+            prepareReverb(sampleRate, numChannels);
+            block.setSize(numChannels, config.blockSize, false, false, true);
+
+            // 入力を最後まで通す
+            const juce::int64 length = reader->lengthInSamples;
+            for (juce::int64 position = 0; position < length; position += config.blockSize)
+            {
+                const int n = static_cast<int>(std::min<juce::int64>(config.blockSize, length - position));
+                juce::AudioBuffer<float> view(block.getArrayOfWritePointers(), numChannels, n);
+                reader->read(&view, 0, n, position, true, true);
+                reverb.process(view);
+                writer->writeFromAudioSampleBuffer(view, 0, n);
+            }
+
+            // 出力のピークがしきい値を下回る（または wet の経路が止まる）までテールを書き出す
+            const float threshold = juce::Decibels::decibelsToGain(config.tailThresholdDb);
+            const auto maxTailSamples = static_cast<juce::int64>(config.maxTailSeconds * sampleRate);
+            juce::int64 tailSamples = 0;
+            while (tailSamples < maxTailSamples)
+            {
+                const int n = static_cast<int>(std::min<juce::int64>(config.blockSize, maxTailSamples - tailSamples));
+                juce::AudioBuffer<float> view(block.getArrayOfWritePointers(), numChannels, n);
+                view.clear();
+                reverb.process(view);
+
+                float peak = 0.0f;
+                for (int ch = 0; ch < numChannels; ++ch)
+                    peak = std::max(peak, view.getMagnitude(ch, 0, n));
+                if (peak < threshold || reverb.isSleeping())
+                    break;
+
+                writer->writeFromAudioSampleBuffer(view, 0, n);
+                tailSamples += n;
+            }
+
+            result.ok = true;
+            result.inputSeconds = static_cast<double>(length) / sampleRate;
+            result.tailSeconds = static_cast<double>(tailSamples) / sampleRate;
+            return result;
+        }
+
+        // サンプルレートかチャンネル数が前のジョブと違うときだけ prepare し直す
+        void prepareReverb(double sampleRate, int numChannels)
+        {
+            if (sampleRate == preparedSampleRate && numChannels == preparedChannels)
+            {
+                reverb.clear();
+                return;
+            }
+
+            reverb.setNonRealtime(true);
+            reverb.setParallelLanes(false);
+            reverb.prepare(sampleRate, config.blockSize, juce::AudioChannelSet::canonicalChannelSet(numChannels));
+            reverb.setEngine(config.engine);
+            reverb.setQuality(config.quality);
+            reverb.setPreset(config.preset);
+            if (config.domeAmount >= 0.0f)
+                reverb.setDomeAmount(config.domeAmount);
+
+            preparedSampleRate = sampleRate;
+            preparedChannels = numChannels;
+        }
+
+        const RenderConfig& config;
+        juce::AudioFormatManager& formatManager;
+        std::atomic<int>& nextJob;
+        juce::Array<RenderResult>& results;
+
+        DomeReverb<float> reverb;
+        juce::AudioBuffer<float> block;
+        double preparedSampleRate = 0.0;
+        int preparedChannels = 0;
+    };
+
+    //==========================================================================
+    // コマンドライン解析（フォルダは直下の WAV / AIFF をすべて追加する）
+    bool parseArguments(const juce::StringArray& args, RenderConfig& config)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const auto next = [&]() { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+            if (arg == "--preset")
+            {
+                const int index = indexOf(presetNames, 4, next());
+                if (index < 0) return false;
+                config.preset = static_cast<DomePreset>(index);
+            }
+            else if (arg == "--engine")
+            {
+                const int index = indexOf(engineNames, 3, next());
+                if (index < 0) return false;
+                config.engine = static_cast<ReverbEngine>(index);
+            }
+            else if (arg == "--quality")
+            {
+                const int index = indexOf(qualityNames, 3, next());
+                if (index < 0) return false;
+                config.quality = static_cast<ReverbQuality>(index);
+            }
+            else if (arg == "--amount")          config.domeAmount = juce::jlimit(0.0f, 1.0f, next().getFloatValue());
+            else if (arg == "--threads")         config.numThreads = juce::jmax(0, next().getIntValue());
+            else if (arg == "--tail-threshold")  config.tailThresholdDb = next().getFloatValue();
+            else if (arg == "--max-tail")        config.maxTailSeconds = juce::jmax(0.0, next().getDoubleValue());
+            else if (arg == "--block")           config.blockSize = juce::jlimit(64, 65536, next().getIntValue());
+            else if (arg == "--output-dir")      config.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--suffix")          config.suffix = next();
+            else if (arg == "--format")          config.format = next();
+            else if (arg.startsWith("--"))
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return false;
+            }
+            else
+            {
+                const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(arg);
+                if (file.isDirectory())
+                {
+                    auto found = file.findChildFiles(juce::File::findFiles, false, "*.wav;*.aif;*.aiff");
+                    found.sort();
+                    config.inputs.addArray(found);
+                }
+                else
+                {
+                    config.inputs.add(file);
+                }
+            }
+        }
+
+        return config.inputs.size() > 0
+            && (config.format.isEmpty() || config.format == "wav" || config.format == "aiff");
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    RenderConfig config;
+    if (! parseArguments(args, config))
+    {
+        std::cerr << "Usage: DomeBatchRender [--preset arena|stadium|hall|club] [--amount 0-1] "
+                     "[--engine classic|fdn8|fdn16] [--quality eco|standard|high] [--threads n] "
+                     "[--tail-threshold dB] [--max-tail s] [--block n] [--output-dir dir] "
+                     "[--suffix text] [--format wav|aiff] files-or-folders...\n";
+        return 1;
+    }
+
+    if (config.format.isNotEmpty())
+        config.format = "." + config.format;
+    if (config.outputDirectory != juce::File())
+        config.outputDirectory.createDirectory();
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    const int numThreads = juce::jlimit(1, config.inputs.size(),
+                                        config.numThreads > 0 ? config.numThreads : juce::SystemStats::getNumCpus());
+
+    // 結果はジョブごとの枠に書く（ワーカーどうしで共有するのはジョブ番号の atomic だけ）
+    juce::Array<RenderResult> results;
+    results.resize(config.inputs.size());
+    std::atomic<int> nextJob { 0 };
+
+    const auto start = juce::Time::getHighResolutionTicks();
+    {
+        juce::OwnedArray<RenderWorker> workers;
+        for (int t = 0; t < numThreads; ++t)
+            workers.add(new RenderWorker(config, formatManager, nextJob, results))->startThread();
+
+        for (auto* worker : workers)
+            worker->waitForThreadToExit(-1);
+    }
+    const double wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    // ファイルごとの結果と全体のスループット
+    int failures = 0;
+    double audioSeconds = 0.0;
+    for (int i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results.getReference(i);
+        if (r.ok)
+        {
+            audioSeconds += r.inputSeconds + r.tailSeconds;
+            std::cout << r.output.getFullPathName() << "  "
+                      << juce::String(r.inputSeconds, 1) << " s + tail " << juce::String(r.tailSeconds, 1) << " s  ("
+                      << juce::String(r.renderSeconds, 2) << " s)\n";
+        }
+        else
+        {
+            ++failures;
+            std::cout << "FAILED " << config.inputs.getReference(i).getFullPathName() << ": " << r.message << "\n";
+        }
+    }
+
+    std::cout << results.size() - failures << " files, " << juce::String(audioSeconds, 1) << " s of audio in "
+              << juce::String(wallSeconds, 2) << " s on " << numThreads << " threads ("
+              << juce::String(wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0, 1) << "x realtime)\n";
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,879 @@
+/*
+  ==============================================================================
+    BenchmarkMain.cpp
+    DomeReverb と各DSPステージのマイクロベンチマーク（GUIなしのコンソールアプリ）
+
+    サンプルレート・ブロックサイズ・プリセットの組み合わせごとに
+    ns/sample とリアルタイム比（何倍速で処理できるか）を計測し、
+    表・CSV・JSON で出力する。多チャンネルの行の ns/sample は
+    全チャンネル分の1サンプル（1フレーム）あたり。
+
+    使い方:
+      DomeReverbBenchmark [--rates 44100,48000,96000,192000]
+                          [--blocks 1,16,64,256,1024,4096]
+                          [--seconds 2] [--repeats 5]
+                          [--format table|csv|json] [--output ファイル名]
+      DomeReverbBenchmark --state [--instances 500]
+      DomeReverbBenchmark --memory [--rates ...] [--instances 500]
+      DomeReverbBenchmark --profile [--rates 48000] [--blocks 256] [--seconds 2]
+                          [--trace dome_profile.json] [--output 集計表のファイル名]
+
+    --state ではプラグインのステート保存・復元の時間を、インスタンスの数だけ
+    まとめて計測する（バイナリ形式と、以前の XML 形式の復元）。
+    --memory では DomeReverb 1インスタンスのメモリの内訳（遅延線の slab と作業バッファ）を
+    サンプルレート・チャンネル配置ごとに表示する。
+    --profile では DomeReverb のステージ（プリEQ・プリディレイ・コム・クロスフィード・オールパス・
+    ポストフィルター・ミックス等）ごとの時間を、エンジン・品質ごとに Chrome のトレース（JSON）と
+    集計表に出す。Linux ではハードウェアカウンター（サイクル・キャッシュミス）も構成ごとに添える。
+    CMake の DOMELIVE_STAGE_PROFILING=ON でビルドしたときだけ使える（StageProfiler.h）。
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DSP/DomeReverb.h"
+#include "DSP/CombFilter.h"
+#include "DSP/AllPassFilter.h"
+#include "DSP/CombBank.h"
+#include "DSP/MultichannelBiquadCascade.h"
+#include "DSP/FdnTank.h"
+#include "DSP/EarlyReflections.h"
+#include "DSP/PartitionedConvolver.h"
+#include "DSP/StageProfiler.h"
+#include "PluginProcessor.h"
+#include "PerfCounters.h"
+#include <iostream>
+#include <functional>
+
+namespace
+{
+    //==========================================================================
+    // 計測設定と結果
+    struct BenchmarkConfig
+    {
+        juce::Array<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+        juce::Array<int> blockSizes { 1, 16, 64, 256, 1024, 4096 };
+        double secondsOfAudio = 2.0;
+        int repeats = 5;
+        juce::String format = "table";
+        juce::String outputPath;
+        bool state = false;         // ステート保存・復元のベンチマーク
+        bool memory = false;        // メモリの内訳
+        int numInstances = 500;
+        bool profile = false;       // ステージごとのプロファイル
+        juce::String tracePath = "dome_profile.json";
+        bool customRates = false;   // --rates / --blocks を指定したか
+        bool customBlocks = false;
+    };
+
+    struct BenchmarkResult
+    {
+        juce::String stage;
+        juce::String preset;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        double nsPerSample = 0.0;
+        double realtimeFactor = 0.0;
+    };
+
+    const char* presetNames[] = { "Arena", "Stadium", "Hall", "Club" };
+
+    //==========================================================================
+    // 1ステージ分の処理を numSamples 回ブロック単位で呼び、最速の回の ns/sample を返す。
+    // processBlock(blockSize) が1ブロック分を処理する
+    double measure(const BenchmarkConfig& config, double sampleRate, int blockSize,
+                   const std::function<void(int)>& processBlock)
+    {
+        const int totalSamples = static_cast<int>(config.secondsOfAudio * sampleRate);
+        const int numBlocks = juce::jmax(1, totalSamples / blockSize);
+
+        // ウォームアップ（キャッシュ・分岐予測を温める）
+        for (int b = 0; b < juce::jmin(numBlocks, 64); ++b)
+            processBlock(blockSize);
+
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < config.repeats; ++r)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int b = 0; b < numBlocks; ++b)
+                processBlock(blockSize);
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            const double seconds = juce::Time::highResolutionTicksToSeconds(end - start);
+            best = juce::jmin(best, seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize));
+        }
+        return best;
+    }
+
+    BenchmarkResult makeResult(const juce::String& stage, const juce::String& preset,
+                               double sampleRate, int blockSize, double nsPerSample)
+    {
+        BenchmarkResult r;
+        r.stage = stage;
+        r.preset = preset;
+        r.sampleRate = sampleRate;
+        r.blockSize = blockSize;
+        r.nsPerSample = nsPerSample;
+        r.realtimeFactor = nsPerSample > 0.0 ? (1.0e9 / sampleRate) / nsPerSample : 0.0;
+        return r;
+    }
+
+    // 再現性のため固定シードのノイズを入力に使う
+    void fillNoise(juce::AudioBuffer<float>& buffer)
+    {
+        juce::Random random(12345);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = random.nextFloat() * 0.5f - 0.25f;
+        }
+    }
+
+    //==========================================================================
+    // ステージ単体のベンチマーク（DomeReverb と同じ設定で構成する）
+    void benchmarkStages(const BenchmarkConfig& config, double sampleRate, int blockSize,
+                         juce::Array<BenchmarkResult>& results)
+    {
+        juce::AudioBuffer<float> input(2, blockSize);
+        juce::AudioBuffer<float> work(2, blockSize);
+        fillNoise(input);
+
+        auto* inL = input.getReadPointer(0);
+        auto* inR = input.getReadPointer(1);
+        auto* outL = work.getWritePointer(0);
+        auto* outR = work.getWritePointer(1);
+
+        constexpr int numStereoLanes = 2 * CombBank<float>::combsPerChannel;
+        const float combDelays[numStereoLanes] = {
+            29.7f, 37.1f, 41.1f, 43.7f, 47.3f, 53.9f, 59.3f, 61.7f,
+            31.1f, 39.7f, 43.3f, 47.1f, 51.7f, 57.3f, 63.1f, 67.9f
+        };
+        const float allPassDelays[8] = { 5.0f, 6.7f, 10.0f, 12.4f, 5.3f, 7.1f, 11.3f, 13.7f };
+
+        // プリEQ（7セクション、L/R。DomeReverb と同じ MultichannelBiquadCascade）
+        {
+            MultichannelBiquadCascade<float, 7> preEQ;
+            preEQ.prepare(2, blockSize);
+            preEQ.setSection(0, juce::IIRCoefficients::makeLowShelf(sampleRate, 50.0, 0.7, 1.12f));
+            preEQ.setSection(1, juce::IIRCoefficients::makePeakFilter(sampleRate, 100.0, 1.5, 0.89f));
+            preEQ.setSection(2, juce::IIRCoefficients::makePeakFilter(sampleRate, 200.0, 1.0, 0.71f));
+            preEQ.setSection(3, juce::IIRCoefficients::makePeakFilter(sampleRate, 400.0, 1.2, 0.63f));
+            preEQ.setSection(4, juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, 1.26f));
+            preEQ.setSection(5, juce::IIRCoefficients::makePeakFilter(sampleRate, 4000.0, 1.5, 2.0f));
+            preEQ.setSection(6, juce::IIRCoefficients::makeLowPass(sampleRate, 10000.0, 0.5));
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                juce::FloatVectorOperations::copy(outL, inL, n);
+                juce::FloatVectorOperations::copy(outR, inR, n);
+                preEQ.processBlock(work.getArrayOfWritePointers(), n);
+            });
+            results.add(makeResult("preEQ", "-", sampleRate, blockSize, ns));
+        }
+
+        // コムフィルターバンク（L/R 16本、SoA）
+        {
+            CombBank<float> bank;
+            DelaySlab<float> slab;
+            slab.layout([&] { bank.prepare(sampleRate, combDelays, 2, slab); });
+            bank.setFeedback(0.82f);
+            bank.setDamping(0.3f);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                bank.processBlock(inL, inR, outL, outR, n);
+            });
+            results.add(makeResult("combBank", "-", sampleRate, blockSize, ns));
+        }
+
+        // 個別の CombFilter 16本（比較用）
+        {
+            std::array<CombFilter<float>, numStereoLanes> combs;
+            for (int i = 0; i < numStereoLanes; ++i)
+            {
+                combs[i].prepare(sampleRate, 150.0f);
+                combs[i].setDelayTime(combDelays[i]);
+                combs[i].setFeedback(0.82f);
+                combs[i].setDamping(0.3f);
+            }
+
+            juce::HeapBlock<float> scratch(blockSize);
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                juce::FloatVectorOperations::clear(outL, n);
+                juce::FloatVectorOperations::clear(outR, n);
+                for (int i = 0; i < numStereoLanes; ++i)
+                {
+                    const bool left = i < CombBank<float>::combsPerChannel;
+                    combs[i].processBlock(left ? inL : inR, scratch, n);
+                    juce::FloatVectorOperations::add(left ? outL : outR, scratch, n);
+                }
+            });
+            results.add(makeResult("combFilter x16", "-", sampleRate, blockSize, ns));
+        }
+
+        // オールパスフィルター（L/R 各4段）
+        {
+            std::array<AllPassFilter<float>, 8> allPasses;
+            for (int i = 0; i < 8; ++i)
+            {
+                allPasses[i].prepare(sampleRate, 30.0f);
+                allPasses[i].setDelayTime(allPassDelays[i]);
+                allPasses[i].setCoefficient(0.5f);
+            }
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                juce::FloatVectorOperations::copy(outL, inL, n);
+                juce::FloatVectorOperations::copy(outR, inR, n);
+                for (int i = 0; i < 4; ++i)
+                {
+                    allPasses[i].processBlock(outL, outL, n);
+                    allPasses[i + 4].processBlock(outR, outR, n);
+                }
+            });
+            results.add(makeResult("allPass x8", "-", sampleRate, blockSize, ns));
+        }
+
+        // 初期反射（Arena の部屋、L/R 各 13 タップ）
+        {
+            std::array<EarlyReflections<float>, 2> early;
+            DelaySlab<float> slab;
+            slab.layout([&]
+            {
+                for (auto& e : early)
+                    e.prepare(sampleRate, blockSize, slab);
+            });
+            for (int ch = 0; ch < 2; ++ch)
+                early[ch].design(RoomGeometry {}, ch == 0 ? -1.0f : 1.0f);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                early[0].process(inL, outL, n);
+                early[1].process(inR, outR, n);
+            });
+            results.add(makeResult("earlyReflections", "-", sampleRate, blockSize, ns));
+        }
+
+        // FDN タンク（Classic のコム + オールパスと比較する）
+        {
+            FdnTank<float, 8> fdn8;
+            DelaySlab<float> slab;
+            slab.layout([&] { fdn8.prepare(sampleRate, slab); });
+            fdn8.setDecayTime(1.9f, 0.85f);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                fdn8.processBlock(inL, inR, outL, outR, n);
+            });
+            results.add(makeResult("fdn8", "-", sampleRate, blockSize, ns));
+        }
+
+        {
+            FdnTank<float, 16> fdn16;
+            DelaySlab<float> slab;
+            slab.layout([&] { fdn16.prepare(sampleRate, slab); });
+            fdn16.setDecayTime(1.9f, 0.85f);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                fdn16.processBlock(inL, inR, outL, outR, n);
+            });
+            results.add(makeResult("fdn16", "-", sampleRate, blockSize, ns));
+        }
+
+        // 分割畳み込み（6秒のトゥルーステレオ IR）
+        // "convolution" はテール区間をワーカーに任せたときのオーディオスレッド側のコスト、
+        // "convolution sync" はテールも同じスレッドで計算したとき（オフラインレンダリング）のコスト
+        {
+            juce::AudioBuffer<float> impulse(4, static_cast<int>(sampleRate * 6.0));
+            fillNoise(impulse);
+            for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+            {
+                float* h = impulse.getWritePointer(ch);
+                for (int i = 0; i < impulse.getNumSamples(); ++i)
+                    h[i] *= std::exp(-6.9f * static_cast<float>(i) / static_cast<float>(impulse.getNumSamples()));
+            }
+            const auto ir = ConvolutionIR::create(impulse, sampleRate, sampleRate);
+
+            for (const bool synchronous : { false, true })
+            {
+                PartitionedConvolver convolver;
+                convolver.prepare(ir, synchronous);
+
+                ConvolutionWorker worker;
+                if (! synchronous)
+                {
+                    worker.setConvolvers({ &convolver });
+                    worker.startThread(juce::Thread::Priority::high);
+                }
+
+                const double ns = measure(config, sampleRate, blockSize, [&](int n)
+                {
+                    convolver.process(inL, inR, outL, outR, n);
+                });
+                worker.stopThread(1000);
+                results.add(makeResult(synchronous ? "convolution sync" : "convolution", "-",
+                                       sampleRate, blockSize, ns));
+            }
+        }
+    }
+
+    // DomeReverb 全体のベンチマーク（プリセットごと）
+    void benchmarkDomeReverb(const BenchmarkConfig& config, double sampleRate, int blockSize,
+                             juce::Array<BenchmarkResult>& results)
+    {
+        juce::AudioBuffer<float> input(2, blockSize);
+        juce::AudioBuffer<float> work(2, blockSize);
+        fillNoise(input);
+
+        const char* engineStageNames[] = { "DomeReverb", "DomeReverb fdn8", "DomeReverb fdn16" };
+
+        for (int e = 0; e < 3; ++e)
+        {
+            for (int p = 0; p < 4; ++p)
+            {
+                DomeReverb<float> reverb;
+                reverb.prepare(sampleRate, blockSize);
+                reverb.setEngine(static_cast<ReverbEngine>(e));
+                reverb.setPreset(static_cast<DomePreset>(p));
+
+                const double ns = measure(config, sampleRate, blockSize, [&](int n)
+                {
+                    for (int ch = 0; ch < 2; ++ch)
+                        work.copyFrom(ch, 0, input, ch, 0, n);
+                    reverb.process(work);
+                });
+                results.add(makeResult(engineStageNames[e], presetNames[p], sampleRate, blockSize, ns));
+            }
+        }
+
+        // Classic の品質ごとのコスト（Standard は上の "DomeReverb" と同じ）
+        for (const auto quality : { ReverbQuality::Eco, ReverbQuality::High })
+        {
+            DomeReverb<float> reverb;
+            reverb.prepare(sampleRate, blockSize);
+            reverb.setQuality(quality);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    work.copyFrom(ch, 0, input, ch, 0, n);
+                reverb.process(work);
+            });
+            results.add(makeResult(quality == ReverbQuality::Eco ? "DomeReverb eco" : "DomeReverb high",
+                                   presetNames[0], sampleRate, blockSize, ns));
+        }
+
+        // wet の経路を間引かずホストのレートで動かした場合（88.2kHz 以上のときだけ差が出る）
+        if (sampleRate >= 88200.0)
+        {
+            DomeReverb<float> reverb;
+            reverb.setMaxInternalSampleRate(0.0);
+            reverb.prepare(sampleRate, blockSize);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    work.copyFrom(ch, 0, input, ch, 0, n);
+                reverb.process(work);
+            });
+            results.add(makeResult("DomeReverb full", presetNames[0], sampleRate, blockSize, ns));
+        }
+
+        // 入力が無音で残響も消え、wet の経路を止めている状態（待機中のインスタンスのコスト）
+        {
+            DomeReverb<float> reverb;
+            reverb.prepare(sampleRate, blockSize);
+            work.clear();
+            for (int b = 0; ! reverb.isSleeping() && b < static_cast<int>(sampleRate * 10.0) / blockSize + 1; ++b)
+                reverb.process(work);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int)
+            {
+                work.clear();
+                reverb.process(work);
+            });
+            results.add(makeResult("DomeReverb idle", presetNames[0], sampleRate, blockSize, ns));
+        }
+
+        // 倍精度のホストと同じく double のバッファのまま処理した場合
+        {
+            juce::AudioBuffer<double> inputDouble;
+            juce::AudioBuffer<double> workDouble(2, blockSize);
+            inputDouble.makeCopyOf(input);
+
+            DomeReverb<double> reverb;
+            reverb.prepare(sampleRate, blockSize);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    workDouble.copyFrom(ch, 0, inputDouble, ch, 0, n);
+                reverb.process(workDouble);
+            });
+            results.add(makeResult("DomeReverb double", presetNames[0], sampleRate, blockSize, ns));
+        }
+
+        // オフラインレンダリング（Classic の L/R のレーンを2スレッドに分けて処理する）
+        {
+            DomeReverb<float> reverb;
+            reverb.setNonRealtime(true);
+            reverb.prepare(sampleRate, blockSize);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    work.copyFrom(ch, 0, input, ch, 0, n);
+                reverb.process(work);
+            });
+            results.add(makeResult("DomeReverb offline", presetNames[0], sampleRate, blockSize, ns));
+        }
+    }
+
+    // 7.1.4 を1インスタンスで処理した場合と、ステレオのインスタンスを
+    // ペアの数（L/R, C, Ls/Rs, Lrs/Rrs, Ltf/Rtf, Ltr/Rtr = 6）だけ並べた場合の比較
+    void benchmarkSurround(const BenchmarkConfig& config, double sampleRate, int blockSize,
+                           juce::Array<BenchmarkResult>& results)
+    {
+        const auto layout = juce::AudioChannelSet::create7point1point4();
+        juce::AudioBuffer<float> input(layout.size(), blockSize);
+        juce::AudioBuffer<float> work(layout.size(), blockSize);
+        fillNoise(input);
+
+        {
+            DomeReverb<float> reverb;
+            reverb.prepare(sampleRate, blockSize, layout);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                for (int ch = 0; ch < layout.size(); ++ch)
+                    work.copyFrom(ch, 0, input, ch, 0, n);
+                reverb.process(work);
+            });
+            results.add(makeResult("DomeReverb 7.1.4", presetNames[0], sampleRate, blockSize, ns));
+        }
+
+        {
+            constexpr int numInstances = 6;
+            std::array<DomeReverb<float>, numInstances> reverbs;
+            for (auto& reverb : reverbs)
+                reverb.prepare(sampleRate, blockSize);
+
+            const double ns = measure(config, sampleRate, blockSize, [&](int n)
+            {
+                for (int i = 0; i < numInstances; ++i)
+                {
+                    juce::AudioBuffer<float> pair(work.getArrayOfWritePointers() + i * 2, 2, n);
+                    for (int ch = 0; ch < 2; ++ch)
+                        pair.copyFrom(ch, 0, input, i * 2 + ch, 0, n);
+                    reverbs[static_cast<size_t>(i)].process(pair);
+                }
+            });
+            results.add(makeResult("stereo x6", presetNames[0], sampleRate, blockSize, ns));
+        }
+    }
+
+    //==========================================================================
+    // ステート保存・復元（セッションを開くときにインスタンスの数だけ呼ばれる）
+    void benchmarkState(const BenchmarkConfig& config)
+    {
+        juce::ScopedJuceInitialiser_GUI juceInitialiser;   // APVTS のタイマー用
+
+        const int numInstances = config.numInstances;
+        juce::OwnedArray<DomeLiveSimulatorAudioProcessor> sources, targets;
+        for (int i = 0; i < numInstances; ++i)
+        {
+            sources.add(new DomeLiveSimulatorAudioProcessor());
+            targets.add(new DomeLiveSimulatorAudioProcessor());
+        }
+
+        // インスタンスごとに違う値にしておく（復元で値が変わるように）
+        juce::Random random(12345);
+        for (auto* processor : sources)
+            for (auto* parameter : processor->getParameters())
+                parameter->setValueNotifyingHost(random.nextFloat());
+
+        auto seconds = [](juce::int64 start)
+        {
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        };
+
+        // 保存（バイナリ）
+        juce::Array<juce::MemoryBlock> binaryStates;
+        binaryStates.resize(numInstances);
+        auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numInstances; ++i)
+            sources[i]->getStateInformation(binaryStates.getReference(i));
+        const double saveSeconds = seconds(start);
+
+        // 以前の XML 形式（比較用）
+        juce::Array<juce::MemoryBlock> xmlStates;
+        xmlStates.resize(numInstances);
+        start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numInstances; ++i)
+        {
+            std::unique_ptr<juce::XmlElement> xml(sources[i]->getAPVTS().copyState().createXml());
+            juce::AudioProcessor::copyXmlToBinary(*xml, xmlStates.getReference(i));
+        }
+        const double saveXmlSeconds = seconds(start);
+
+        // 復元
+        start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numInstances; ++i)
+            targets[i]->setStateInformation(binaryStates.getReference(i).getData(),
+                                            static_cast<int>(binaryStates.getReference(i).getSize()));
+        const double restoreSeconds = seconds(start);
+
+        // 復元できているか
+        int mismatches = 0;
+        for (int i = 0; i < numInstances; ++i)
+            for (int p = 0; p < sources[i]->getParameters().size(); ++p)
+                if (sources[i]->getParameters()[p]->getValue() != targets[i]->getParameters()[p]->getValue())
+                    ++mismatches;
+
+        start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < numInstances; ++i)
+            sources[i]->setStateInformation(xmlStates.getReference(i).getData(),
+                                            static_cast<int>(xmlStates.getReference(i).getSize()));
+        const double restoreXmlSeconds = seconds(start);
+
+        auto row = [&](const char* name, double total, const juce::MemoryBlock& example)
+        {
+            std::cout << juce::String(name).paddedRight(' ', 22)
+                      << juce::String(total * 1.0e3, 2).paddedLeft(' ', 10) << " ms"
+                      << juce::String(total * 1.0e6 / numInstances, 2).paddedLeft(' ', 10) << " us/instance"
+                      << juce::String(static_cast<int>(example.getSize())).paddedLeft(' ', 8) << " bytes\n";
+        };
+
+        std::cout << numInstances << " instances\n";
+        row("save binary", saveSeconds, binaryStates.getReference(0));
+        row("save xml (legacy)", saveXmlSeconds, xmlStates.getReference(0));
+        row("restore binary", restoreSeconds, binaryStates.getReference(0));
+        row("restore xml (legacy)", restoreXmlSeconds, xmlStates.getReference(0));
+        if (mismatches > 0)
+            std::cout << "WARNING: " << mismatches << " parameter values differ after binary restore\n";
+    }
+
+    //==========================================================================
+    // メモリの内訳（DomeReverb 1インスタンス、KB）と、--instances の数だけ並べたときの合計（MB）
+    void reportMemory(const BenchmarkConfig& config)
+    {
+        auto kb = [](size_t bytes) { return juce::String(static_cast<double>(bytes) / 1024.0, 1).paddedLeft(' ', 9); };
+
+        std::cout << juce::String("layout").paddedRight(' ', 8) << juce::String("rate").paddedLeft(' ', 8)
+                  << juce::String("classic").paddedLeft(' ', 9) << juce::String("fdn").paddedLeft(' ', 9)
+                  << juce::String("predelay").paddedLeft(' ', 9) << juce::String("early").paddedLeft(' ', 9)
+                  << juce::String("slab").paddedLeft(' ', 9) << juce::String("work").paddedLeft(' ', 9)
+                  << juce::String("total").paddedLeft(' ', 9)
+                  << juce::String("x" + juce::String(config.numInstances) + " MB").paddedLeft(' ', 12) << "\n";
+
+        for (auto sampleRate : config.sampleRates)
+        {
+            for (const auto& layout : { juce::AudioChannelSet::stereo(), juce::AudioChannelSet::create7point1point4() })
+            {
+                DomeReverb<float> reverb;
+                reverb.prepare(sampleRate, 512, layout);
+                const auto report = reverb.getMemoryReport();
+
+                std::cout << (layout.size() == 2 ? juce::String("stereo") : juce::String("7.1.4")).paddedRight(' ', 8)
+                          << juce::String(static_cast<int>(sampleRate)).paddedLeft(' ', 8)
+                          << kb(report.classicTanks) << kb(report.fdnTanks) << kb(report.preDelay)
+                          << kb(report.earlyReflections) << kb(report.delaySlab) << kb(report.workBuffers)
+                          << kb(report.total())
+                          << juce::String(static_cast<double>(report.total()) * config.numInstances / (1024.0 * 1024.0), 1)
+                                 .paddedLeft(' ', 12) << "\n";
+            }
+        }
+    }
+
+    //==========================================================================
+    // ステージごとのプロファイル（StageProfiler の記録をトレースと集計表にする）
+    // ハードウェアカウンターは構成ごとの合計（ステージごとに読むとシステムコールで計測が歪むため）
+    bool profileStages(const BenchmarkConfig& config)
+    {
+        if (! StageProfiler::enabled)
+        {
+            std::cerr << "--profile needs a build configured with -DDOMELIVE_STAGE_PROFILING=ON\n";
+            return false;
+        }
+
+        struct ProfilePath
+        {
+            const char* name;
+            ReverbEngine engine;
+            ReverbQuality quality;
+        };
+        const ProfilePath paths[] = {
+            { "classic eco",      ReverbEngine::Classic,     ReverbQuality::Eco },
+            { "classic standard", ReverbEngine::Classic,     ReverbQuality::Standard },
+            { "classic high",     ReverbEngine::Classic,     ReverbQuality::High },
+            { "fdn8",             ReverbEngine::Fdn8,        ReverbQuality::Standard },
+            { "fdn16",            ReverbEngine::Fdn16,       ReverbQuality::Standard },
+            { "convolution",      ReverbEngine::Convolution, ReverbQuality::Standard },
+        };
+
+        // 指定がなければ 48kHz / 256 だけ（全部の組み合わせだと構成が多すぎる）
+        const auto sampleRates = config.customRates ? config.sampleRates : juce::Array<double> { 48000.0 };
+        const auto blockSizes = config.customBlocks ? config.blockSizes : juce::Array<int> { 256 };
+        constexpr int collectInterval = 256;   // このブロック数ごとに記録を取り出す（リングがあふれないように）
+
+        StageProfiler::Session session;
+        bool countersAvailable = false;
+
+        for (auto sampleRate : sampleRates)
+        {
+            for (auto blockSize : blockSizes)
+            {
+                juce::AudioBuffer<float> input(2, blockSize);
+                juce::AudioBuffer<float> work(2, blockSize);
+                fillNoise(input);
+
+                for (const auto& path : paths)
+                {
+                    session.beginSection(juce::String(path.name) + ", " + juce::String(static_cast<int>(sampleRate))
+                                         + " Hz, block " + juce::String(blockSize));
+
+                    PerfCounters counters;   // レーンのワーカーも数えるよう、DomeReverb より先に開く
+                    countersAvailable = countersAvailable || counters.isAvailable();
+
+                    const int numBlocks = juce::jmax(1, static_cast<int>(config.secondsOfAudio * sampleRate) / blockSize);
+                    {
+                        DomeReverb<float> reverb;
+                        reverb.prepare(sampleRate, blockSize);
+                        if (path.engine == ReverbEngine::Convolution)
+                        {
+                            juce::AudioBuffer<float> impulse(2, static_cast<int>(reverb.getInternalSampleRate() * 2.0));
+                            fillNoise(impulse);
+                            for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+                            {
+                                float* h = impulse.getWritePointer(ch);
+                                for (int i = 0; i < impulse.getNumSamples(); ++i)
+                                    h[i] *= std::exp(-6.9f * static_cast<float>(i) / static_cast<float>(impulse.getNumSamples()));
+                            }
+                            reverb.setImpulseResponse(ConvolutionIR::create(impulse, reverb.getInternalSampleRate(),
+                                                                            reverb.getInternalSampleRate()));
+                        }
+                        reverb.setEngine(path.engine);
+                        reverb.setQuality(path.quality);
+                        reverb.setPreset(DomePreset::Arena);
+
+                        auto processBlocks = [&](int count)
+                        {
+                            for (int b = 0; b < count; ++b)
+                            {
+                                for (int ch = 0; ch < 2; ++ch)
+                                    work.copyFrom(ch, 0, input, ch, 0, blockSize);
+                                reverb.process(work);
+                            }
+                        };
+
+                        // ウォームアップの分は捨てる
+                        processBlocks(64);
+                        session.discard();
+
+                        // 記録の取り出しは数えない
+                        for (int done = 0; done < numBlocks; done += collectInterval)
+                        {
+                            counters.start();
+                            processBlocks(juce::jmin(collectInterval, numBlocks - done));
+                            counters.stop();
+                            session.collect();
+                        }
+                    }
+
+                    // ワーカーの分はスレッドが終わったときに足し込まれるので、DomeReverb を破棄してから読む
+                    // （ワーカーがジョブを待って回っている間も数に入る）
+                    const auto totals = counters.snapshot();
+
+                    if (counters.isAvailable())
+                    {
+                        const double samples = static_cast<double>(numBlocks) * blockSize;
+                        const auto cycles = static_cast<double>(totals[PerfCounters::cycles]);
+                        session.addCounter("cycles/sample", cycles / samples);
+                        if (counters.isAvailable(PerfCounters::instructions) && cycles > 0.0)
+                            session.addCounter("instructions/cycle", static_cast<double>(totals[PerfCounters::instructions]) / cycles);
+                        if (counters.isAvailable(PerfCounters::cacheMisses))
+                            session.addCounter("cache misses/1k samples", 1000.0 * static_cast<double>(totals[PerfCounters::cacheMisses]) / samples);
+                        if (counters.isAvailable(PerfCounters::cacheReferences) && totals[PerfCounters::cacheReferences] > 0)
+                            session.addCounter("cache miss %", 100.0 * static_cast<double>(totals[PerfCounters::cacheMisses])
+                                                                   / static_cast<double>(totals[PerfCounters::cacheReferences]));
+                    }
+                    std::cerr << "." << std::flush;
+                }
+            }
+        }
+        std::cerr << "\n";
+
+        auto summary = session.toSummaryTable();
+        if (! countersAvailable)
+            summary << "(hardware counters unavailable: not Linux, or perf_event_paranoid too strict)\n";
+
+        const auto traceFile = juce::File::getCurrentWorkingDirectory().getChildFile(config.tracePath);
+        traceFile.replaceWithText(session.toChromeTrace());
+        summary << "Chrome trace written to " << traceFile.getFullPathName() << "\n";
+
+        if (config.outputPath.isNotEmpty())
+            juce::File::getCurrentWorkingDirectory().getChildFile(config.outputPath).replaceWithText(summary);
+        else
+            std::cout << summary;
+
+        return true;
+    }
+
+    //==========================================================================
+    // 出力
+    juce::String formatTable(const juce::Array<BenchmarkResult>& results)
+    {
+        juce::String text;
+        text << juce::String("stage").paddedRight(' ', 18)
+             << juce::String("preset").paddedRight(' ', 9)
+             << juce::String("rate").paddedLeft(' ', 8)
+             << juce::String("block").paddedLeft(' ', 7)
+             << juce::String("ns/sample").paddedLeft(' ', 12)
+             << juce::String("x realtime").paddedLeft(' ', 12) << "\n";
+
+        for (const auto& r : results)
+        {
+            text << r.stage.paddedRight(' ', 18)
+                 << r.preset.paddedRight(' ', 9)
+                 << juce::String(static_cast<int>(r.sampleRate)).paddedLeft(' ', 8)
+                 << juce::String(r.blockSize).paddedLeft(' ', 7)
+                 << juce::String(r.nsPerSample, 2).paddedLeft(' ', 12)
+                 << juce::String(r.realtimeFactor, 1).paddedLeft(' ', 12) << "\n";
+        }
+        return text;
+    }
+
+    juce::String formatCsv(const juce::Array<BenchmarkResult>& results)
+    {
+        juce::String text = "stage,preset,sample_rate,block_size,ns_per_sample,realtime_factor\n";
+        for (const auto& r : results)
+            text << r.stage << "," << r.preset << "," << static_cast<int>(r.sampleRate) << ","
+                 << r.blockSize << "," << juce::String(r.nsPerSample, 4) << ","
+                 << juce::String(r.realtimeFactor, 2) << "\n";
+        return text;
+    }
+
+    juce::String formatJson(const juce::Array<BenchmarkResult>& results)
+    {
+        juce::Array<juce::var> array;
+        for (const auto& r : results)
+        {
+            auto* object = new juce::DynamicObject();
+            object->setProperty("stage", r.stage);
+            object->setProperty("preset", r.preset);
+            object->setProperty("sample_rate", r.sampleRate);
+            object->setProperty("block_size", r.blockSize);
+            object->setProperty("ns_per_sample", r.nsPerSample);
+            object->setProperty("realtime_factor", r.realtimeFactor);
+            array.add(juce::var(object));
+        }
+        return juce::JSON::toString(juce::var(array));
+    }
+
+    //==========================================================================
+    // コマンドライン解析
+    bool parseArguments(const juce::StringArray& args, BenchmarkConfig& config)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const auto next = [&]() { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+            if (arg == "--rates")
+            {
+                config.sampleRates.clear();
+                for (const auto& token : juce::StringArray::fromTokens(next(), ",", ""))
+                    config.sampleRates.add(token.getDoubleValue());
+                config.customRates = true;
+            }
+            else if (arg == "--blocks")
+            {
+                config.blockSizes.clear();
+                for (const auto& token : juce::StringArray::fromTokens(next(), ",", ""))
+                    config.blockSizes.add(juce::jmax(1, token.getIntValue()));
+                config.customBlocks = true;
+            }
+            else if (arg == "--seconds") config.secondsOfAudio = juce::jmax(0.01, next().getDoubleValue());
+            else if (arg == "--repeats") config.repeats = juce::jmax(1, next().getIntValue());
+            else if (arg == "--format")  config.format = next();
+            else if (arg == "--output")  config.outputPath = next();
+            else if (arg == "--state")   config.state = true;
+            else if (arg == "--memory")  config.memory = true;
+            else if (arg == "--instances") config.numInstances = juce::jmax(1, next().getIntValue());
+            else if (arg == "--profile") config.profile = true;
+            else if (arg == "--trace")   config.tracePath = next();
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return false;
+            }
+        }
+        return config.format == "table" || config.format == "csv" || config.format == "json";
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    BenchmarkConfig config;
+    if (! parseArguments(args, config))
+    {
+        std::cerr << "Usage: DomeReverbBenchmark [--rates r1,r2,...] [--blocks b1,b2,...] "
+                     "[--seconds s] [--repeats n] [--format table|csv|json] [--output file]\n"
+                     "       DomeReverbBenchmark --state [--instances n]\n"
+                     "       DomeReverbBenchmark --memory [--rates r1,r2,...] [--instances n]\n"
+                     "       DomeReverbBenchmark --profile [--rates r1,...] [--blocks b1,...] [--seconds s] "
+                     "[--trace file.json] [--output file]\n";
+        return 1;
+    }
+
+    if (config.state)
+    {
+        benchmarkState(config);
+        return 0;
+    }
+
+    if (config.memory)
+    {
+        reportMemory(config);
+        return 0;
+    }
+
+    if (config.profile)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        return profileStages(config) ? 0 : 1;
+    }
+
+    juce::ScopedNoDenormals noDenormals;
+    juce::Array<BenchmarkResult> results;
+
+    for (auto sampleRate : config.sampleRates)
+    {
+        for (auto blockSize : config.blockSizes)
+        {
+            benchmarkStages(config, sampleRate, blockSize, results);
+            benchmarkDomeReverb(config, sampleRate, blockSize, results);
+            benchmarkSurround(config, sampleRate, blockSize, results);
+            std::cerr << "." << std::flush;
+        }
+    }
+    std::cerr << "\n";
+
+    const auto text = config.format == "csv"  ? formatCsv(results)
+                    : config.format == "json" ? formatJson(results)
+                                              : formatTable(results);
+
+    if (config.outputPath.isNotEmpty())
+        juce::File::getCurrentWorkingDirectory().getChildFile(config.outputPath).replaceWithText(text);
+    else
+        std::cout << text;
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+    PerfCounters.h
+    ハードウェアカウンター（Linux の perf_event_open）
+
+    サイクル・命令・キャッシュ参照・キャッシュミスを、呼び出したスレッドと
+    このあとそのスレッドから作られるスレッド（DomeReverb のレーンのワーカーなど）の合計で数える。
+    DomeReverb を作る前に PerfCounters を作ること。
+    開いた時点では止まっていて、start() / stop() の間だけ数える（子スレッドの分も一緒に止まる）。
+    子スレッドの分は、そのスレッドが終わったときに初めて read() の値に足し込まれる（inherit の仕様）。
+    ワーカーも含めた値を取るには、stop() してから DomeReverb を破棄して（ワーカーを join して）から読むこと。
+    動いている間に読むと、呼び出したスレッドの分しか入っていない。
+    Linux 以外や、権限（/proc/sys/kernel/perf_event_paranoid）で開けないときは isAvailable() が false。
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+class PerfCounters
+{
+public:
+    enum Counter { cycles, instructions, cacheReferences, cacheMisses, numCounters };
+
+    PerfCounters()
+    {
+       #if defined(__linux__)
+        const std::uint64_t configs[numCounters] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                     PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES };
+        for (int c = 0; c < numCounters; ++c)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[c];
+            attr.inherit = 1;            // あとから作られるスレッドも数える
+            attr.disabled = 1;           // start() まで数えない
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+       #endif
+    }
+
+    ~PerfCounters()
+    {
+       #if defined(__linux__)
+        for (int fd : fds)
+            if (fd >= 0)
+                close(fd);
+       #endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // 数え始める / 止める（子スレッドのカウンターにも効く）
+    void start() { setEnabled(true); }
+    void stop()  { setEnabled(false); }
+
+    bool isAvailable() const { return fds[cycles] >= 0; }
+    bool isAvailable(Counter counter) const { return fds[counter] >= 0; }
+
+    // start() / stop() の間に数えた値の合計（開けなかったカウンターは 0）。
+    // 子スレッドの分は終わったスレッドのものだけ入る
+    std::uint64_t read(Counter counter) const
+    {
+        std::uint64_t value = 0;
+       #if defined(__linux__)
+        if (fds[counter] >= 0 && ::read(fds[counter], &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+            value = 0;
+       #else
+        juce::ignoreUnused(counter);
+       #endif
+        return value;
+    }
+
+    struct Snapshot
+    {
+        std::uint64_t values[numCounters] = {};
+
+        std::uint64_t operator[](Counter counter) const { return values[counter]; }
+    };
+
+    Snapshot snapshot() const
+    {
+        Snapshot s;
+        for (int c = 0; c < numCounters; ++c)
+            s.values[c] = read(static_cast<Counter>(c));
+        return s;
+    }
+
+private:
+    void setEnabled(bool enabled)
+    {
+       #if defined(__linux__)
+        for (int fd : fds)
+            if (fd >= 0)
+                ioctl(fd, enabled ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+       #else
+        juce::ignoreUnused(enabled);
+       #endif
+    }
+
+    int fds[numCounters] = { -1, -1, -1, -1 };
+};
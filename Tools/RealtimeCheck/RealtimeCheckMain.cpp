@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+    RealtimeCheckMain.cpp
+    processBlock のリアルタイム安全性チェック（コンソールアプリ）
+
+    プラグインのプロセッサーを GUI なしで生成し、サンプルレート・ブロックサイズを
+    変えながら再 prepare → パラメータオートメーション・プリセット切り替えを行う。
+    ステレオに加えて 5.1 / 7.1.4 のバス配置でも確認する。
+    エンジンの切り替えには、合成したインパルス応答での Convolution も含める
+    （テール区間のワーカーが間に合わない場合の処理も、実時間より速く回すことで通る）。
+    processBlock の中でメモリ確保・ロック・スリープ等が1回でも呼ばれたら失敗とする。
+
+    あわせて、再 prepare 直後に無音を入れたとき前の設定のテールが
+    残っていないこと（出力が完全に 0 であること）も確認する。
+
+    終了コード: 0 = 問題なし、1 = 違反あり
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "RealtimeInterposers.h"
+#include <iostream>
+
+namespace
+{
+    const char* categoryNames[] = { "allocation", "deallocation", "lock", "syscall" };
+
+    struct TestCase
+    {
+        double sampleRate;
+        int maxBlockSize;
+        juce::AudioChannelSet layout = juce::AudioChannelSet::stereo();
+        juce::AudioProcessor::ProcessingPrecision precision = juce::AudioProcessor::singlePrecision;
+    };
+
+    // 減衰するノイズのトゥルーステレオ IR（実測 IR の代わり）
+    juce::AudioBuffer<float> makeSyntheticImpulseResponse(double sampleRate, double seconds)
+    {
+        juce::AudioBuffer<float> ir(4, static_cast<int>(sampleRate * seconds));
+        juce::Random random(7);
+        for (int ch = 0; ch < ir.getNumChannels(); ++ch)
+            for (int i = 0; i < ir.getNumSamples(); ++i)
+                ir.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f)
+                                        * std::exp(-6.9f * static_cast<float>(i / (sampleRate * seconds))));
+        return ir;
+    }
+
+    // 前の設定で鳴らしたあと、無音を入れて出力が完全に無音になるか
+    template <typename SampleType>
+    bool checkSilenceAfterPrepare(DomeLiveSimulatorAudioProcessor& processor, const TestCase& test)
+    {
+        juce::AudioBuffer<SampleType> buffer(test.layout.size(), test.maxBlockSize);
+        juce::MidiBuffer midi;
+
+        const int numBlocks = static_cast<int>(test.sampleRate * 0.5) / test.maxBlockSize + 1;
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            buffer.clear();
+            processor.processBlock(buffer, midi);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) != SampleType(0))
+                {
+                    std::cout << "  FAIL: stale tail after prepare (" << test.sampleRate
+                              << " Hz, block " << b << ")\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // オートメーションとプリセット切り替えを行いながら processBlock を呼び、違反を数える
+    template <typename SampleType>
+    bool checkAutomation(DomeLiveSimulatorAudioProcessor& processor, const TestCase& test)
+    {
+        auto& apvts = processor.getAPVTS();
+        auto* amountParameter = apvts.getParameter("domeAmount");
+        auto* presetParameter = apvts.getParameter("preset");
+        auto* engineParameter = apvts.getParameter("engine");
+        auto* qualityParameter = apvts.getParameter("quality");
+        auto* governorParameter = apvts.getParameter("qualityGovernor");
+
+        const int numChannels = test.layout.size();
+        juce::AudioBuffer<SampleType> buffer(numChannels, test.maxBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(42);
+
+        const int numBlocks = static_cast<int>(test.sampleRate * 4.0) / test.maxBlockSize;
+        bool passed = true;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            // ホストは最大サイズ以下の任意のブロックを渡してくる
+            const int numSamples = (b % 3 == 0) ? test.maxBlockSize
+                                                : 1 + random.nextInt(test.maxBlockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample(ch, i, static_cast<SampleType>(random.nextFloat() * 0.5f - 0.25f));
+
+            // ノブのオートメーション（ほぼ毎ブロック）
+            if (b % 2 == 0)
+                amountParameter->setValueNotifyingHost(random.nextFloat());
+
+            // ホストからのプリセットパラメータ変更 / プログラム切り替え
+            if (b % 50 == 25)
+                presetParameter->setValueNotifyingHost(static_cast<float>(random.nextInt(4)) / 3.0f);
+            if (b % 90 == 45)
+                processor.setCurrentProgram(random.nextInt(4));
+
+            // エンジン切り替え（Classic / FDN 8 / FDN 16 / Convolution）
+            if (b % 70 == 35)
+                engineParameter->setValueNotifyingHost(static_cast<float>(random.nextInt(4)) / 3.0f);
+
+            // 品質の切り替えとガバナーのオン / オフ
+            if (b % 60 == 30)
+                qualityParameter->setValueNotifyingHost(static_cast<float>(random.nextInt(3)) / 2.0f);
+            if (b % 110 == 55)
+                governorParameter->setValueNotifyingHost(random.nextBool() ? 1.0f : 0.0f);
+
+            juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+            RealtimeInterposers::arm();
+            processor.processBlock(block, midi);
+            const auto report = RealtimeInterposers::disarm();
+
+            if (report.total() > 0)
+            {
+                std::cout << "  FAIL: block " << b << " (" << numSamples << " samples):";
+                for (int c = 0; c < RealtimeInterposers::numCategories; ++c)
+                    if (report.counts[c] > 0)
+                        std::cout << " " << categoryNames[c] << "=" << report.counts[c];
+                std::cout << " first=" << report.firstViolation << "\n";
+                passed = false;
+                break;
+            }
+        }
+        return passed;
+    }
+
+    // ホストの処理精度に合わせたバッファで両方のチェックを行う
+    template <typename SampleType>
+    bool checkProcessing(DomeLiveSimulatorAudioProcessor& processor, const TestCase& test)
+    {
+        const bool silent = checkSilenceAfterPrepare<SampleType>(processor, test);
+        return checkAutomation<SampleType>(processor, test) && silent;
+    }
+}
+
+//==============================================================================
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (! RealtimeInterposers::isSupported())
+    {
+        std::cout << "Realtime safety check is only supported on Linux (glibc) builds "
+                     "with DOMELIVE_RT_SAFETY_CHECKS=1.\n";
+        return 0;
+    }
+
+    // 低いレート → 高いレート → 戻る、の順で再 prepare も確認する
+    const TestCase tests[] = {
+        { 44100.0, 64 },  { 48000.0, 512 }, { 96000.0, 64 },
+        { 192000.0, 1024 }, { 44100.0, 32 }, { 192000.0, 4096 },
+        { 48000.0, 256, juce::AudioChannelSet::create5point1() },
+        { 96000.0, 512, juce::AudioChannelSet::create7point1point4() },
+        { 48000.0, 128 },
+        // 倍精度のホスト（単精度との行き来で再 prepare も確認する）
+        { 48000.0, 512, juce::AudioChannelSet::stereo(), juce::AudioProcessor::doublePrecision },
+        { 96000.0, 256, juce::AudioChannelSet::create5point1(), juce::AudioProcessor::doublePrecision },
+        { 44100.0, 64 }
+    };
+
+    DomeLiveSimulatorAudioProcessor processor;
+    processor.setImpulseResponse(makeSyntheticImpulseResponse(48000.0, 3.0), 48000.0);
+
+    // ホストは releaseResources() を挟まずに prepareToPlay() を呼ぶことがあるので、
+    // ループ中は解放せずに再 prepare する
+    bool passed = true;
+    for (const auto& test : tests)
+    {
+        const bool isDouble = test.precision == juce::AudioProcessor::doublePrecision;
+        std::cout << test.sampleRate << " Hz / " << test.maxBlockSize << " samples / "
+                  << test.layout.getDescription() << (isDouble ? " / double" : "") << "\n";
+
+        // ホストがバス配置を変えてから prepare し直す場合
+        juce::AudioProcessor::BusesLayout layouts;
+        layouts.inputBuses.add(test.layout);
+        layouts.outputBuses.add(test.layout);
+        if (! processor.setBusesLayout(layouts))
+        {
+            std::cout << "  FAIL: layout not supported\n";
+            passed = false;
+            continue;
+        }
+
+        processor.setProcessingPrecision(test.precision);
+        processor.setRateAndBufferSizeDetails(test.sampleRate, test.maxBlockSize);
+        processor.prepareToPlay(test.sampleRate, test.maxBlockSize);
+
+        passed = (isDouble ? checkProcessing<double>(processor, test)
+                           : checkProcessing<float>(processor, test)) && passed;
+    }
+
+    processor.releaseResources();
+
+    std::cout << (passed ? "PASSED" : "FAILED") << "\n";
+    return passed ? 0 : 1;
+}
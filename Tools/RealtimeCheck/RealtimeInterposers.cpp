@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+    RealtimeInterposers.cpp
+    libc / libpthread の関数を実行ファイル側で定義して差し替える
+
+    動的リンクでは実行ファイルのシンボルが共有ライブラリより優先されるため、
+    JUCE や libstdc++ 内部からの呼び出し（operator new → malloc、
+    std::mutex / CriticalSection → pthread_mutex_lock など）もここを通る。
+    本物の実装は glibc の __libc_* か dlsym(RTLD_NEXT) で呼び出す。
+
+    差し替え関数の中ではメモリ確保も静的初期化ガードも使わないこと
+    （どちらも再帰的に malloc / pthread_mutex_lock を呼ぶ可能性がある）。
+  ==============================================================================
+*/
+
+#include "RealtimeInterposers.h"
+#include "RealtimeSafety.h"
+#include <atomic>
+
+namespace
+{
+    std::atomic<bool> armed { false };
+    std::atomic<int> counts[RealtimeInterposers::numCategories];
+    std::atomic<const char*> firstViolation { nullptr };
+
+    void recordCall(RealtimeInterposers::Category category, const char* name) noexcept
+    {
+        if (! armed.load(std::memory_order_relaxed) || ! RealtimeSafety::isInRealtimeSection())
+            return;
+
+        counts[category].fetch_add(1, std::memory_order_relaxed);
+
+        const char* expected = nullptr;
+        firstViolation.compare_exchange_strong(expected, name);
+    }
+}
+
+#if defined(__linux__) && defined(__GLIBC__) && DOMELIVE_RT_SAFETY_CHECKS
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+namespace
+{
+    // dlsym(RTLD_NEXT) で本物の関数を取得（静的初期化ガードを避けるため atomic にキャッシュ）
+    template <typename Function>
+    Function realFunction(std::atomic<void*>& cache, const char* name) noexcept
+    {
+        void* f = cache.load(std::memory_order_acquire);
+        if (f == nullptr)
+        {
+            f = dlsym(RTLD_NEXT, name);
+            cache.store(f, std::memory_order_release);
+        }
+        return reinterpret_cast<Function>(f);
+    }
+
+   #define DOMELIVE_FORWARD(ReturnType, name, signature, ...) \
+        static std::atomic<void*> cache { nullptr }; \
+        return realFunction<ReturnType (*) signature>(cache, #name)(__VA_ARGS__);
+}
+
+extern "C"
+{
+    //==========================================================================
+    // メモリ確保
+    void* malloc(size_t size) noexcept
+    {
+        recordCall(RealtimeInterposers::allocation, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        recordCall(RealtimeInterposers::allocation, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept
+    {
+        recordCall(RealtimeInterposers::allocation, "realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept
+    {
+        recordCall(RealtimeInterposers::allocation, "memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        recordCall(RealtimeInterposers::allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+    {
+        recordCall(RealtimeInterposers::allocation, "posix_memalign");
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            recordCall(RealtimeInterposers::deallocation, "free");
+        __libc_free(ptr);
+    }
+
+    //==========================================================================
+    // ロック
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        recordCall(RealtimeInterposers::lock, "pthread_mutex_lock");
+        DOMELIVE_FORWARD(int, pthread_mutex_lock, (pthread_mutex_t*), mutex)
+    }
+
+    int pthread_mutex_trylock(pthread_mutex_t* mutex) noexcept
+    {
+        recordCall(RealtimeInterposers::lock, "pthread_mutex_trylock");
+        DOMELIVE_FORWARD(int, pthread_mutex_trylock, (pthread_mutex_t*), mutex)
+    }
+
+    int pthread_spin_lock(pthread_spinlock_t* lock) noexcept
+    {
+        recordCall(RealtimeInterposers::lock, "pthread_spin_lock");
+        DOMELIVE_FORWARD(int, pthread_spin_lock, (pthread_spinlock_t*), lock)
+    }
+
+    int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+    {
+        recordCall(RealtimeInterposers::lock, "pthread_cond_wait");
+        DOMELIVE_FORWARD(int, pthread_cond_wait, (pthread_cond_t*, pthread_mutex_t*), cond, mutex)
+    }
+
+    int sem_wait(sem_t* semaphore)
+    {
+        recordCall(RealtimeInterposers::lock, "sem_wait");
+        DOMELIVE_FORWARD(int, sem_wait, (sem_t*), semaphore)
+    }
+
+    //==========================================================================
+    // システムコール
+    int nanosleep(const struct timespec* request, struct timespec* remaining)
+    {
+        recordCall(RealtimeInterposers::syscall, "nanosleep");
+        DOMELIVE_FORWARD(int, nanosleep, (const struct timespec*, struct timespec*), request, remaining)
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        recordCall(RealtimeInterposers::syscall, "usleep");
+        DOMELIVE_FORWARD(int, usleep, (useconds_t), microseconds)
+    }
+
+    int sched_yield() noexcept
+    {
+        recordCall(RealtimeInterposers::syscall, "sched_yield");
+        DOMELIVE_FORWARD(int, sched_yield, (void))
+    }
+
+    ssize_t read(int fd, void* buffer, size_t count)
+    {
+        recordCall(RealtimeInterposers::syscall, "read");
+        DOMELIVE_FORWARD(ssize_t, read, (int, void*, size_t), fd, buffer, count)
+    }
+
+    ssize_t write(int fd, const void* buffer, size_t count)
+    {
+        recordCall(RealtimeInterposers::syscall, "write");
+        DOMELIVE_FORWARD(ssize_t, write, (int, const void*, size_t), fd, buffer, count)
+    }
+}
+
+bool RealtimeInterposers::isSupported() noexcept { return true; }
+
+#else
+
+bool RealtimeInterposers::isSupported() noexcept { return false; }
+
+#endif
+
+//==============================================================================
+void RealtimeInterposers::arm() noexcept
+{
+    for (auto& c : counts)
+        c.store(0);
+    firstViolation.store(nullptr);
+    armed.store(true);
+}
+
+RealtimeInterposers::Report RealtimeInterposers::disarm() noexcept
+{
+    armed.store(false);
+
+    Report report;
+    for (int i = 0; i < numCategories; ++i)
+        report.counts[i] = counts[i].load();
+    report.firstViolation = firstViolation.load();
+    return report;
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+    RealtimeInterposers.h
+    リアルタイム区間内の禁止呼び出し（確保・ロック・システムコール）の集計
+
+    RealtimeInterposers.cpp が malloc / free / pthread_mutex_lock / nanosleep などを
+    実行ファイル側で定義して差し替え、RealtimeSafety::ScopedRealtimeSection の中で
+    呼ばれた回数を数える。Linux (glibc) のみ対応。
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace RealtimeInterposers
+{
+    enum Category
+    {
+        allocation = 0,   // malloc / calloc / realloc / aligned_alloc / operator new
+        deallocation,     // free / operator delete
+        lock,             // pthread_mutex_lock / pthread_spin_lock / sem_wait / cond_wait
+        syscall,          // sleep / yield / read / write
+        numCategories
+    };
+
+    struct Report
+    {
+        int counts[numCategories] = {};
+        const char* firstViolation = nullptr;   // 最初に検出した関数名
+
+        int total() const
+        {
+            int sum = 0;
+            for (auto c : counts)
+                sum += c;
+            return sum;
+        }
+    };
+
+    // この環境で差し替えが有効か
+    bool isSupported() noexcept;
+
+    // 集計を開始（カウンタをリセットして有効化）/ 停止して結果を返す
+    void arm() noexcept;
+    Report disarm() noexcept;
+}
@@ -0,0 +1,918 @@
+/*
+  ==============================================================================
+    RegressionMain.cpp
+    DomeReverb の回帰チェック（GUIなしのコンソールアプリ）
+
+    SIMD・ブロック処理・マルチレート等の最適化の前後で、出力と処理時間が
+    変わっていないことを確かめる。チェックは3つ:
+      1. ゴールデン出力: インパルス・サインスイープ・ノイズを全プリセット × 複数の domeAmount ×
+         サンプルレート（と各エンジン・品質）で通し、参照と比べる。
+         ブロックサイズを変えて何回か通し、どれも誤差のエネルギーが参照の --tolerance-db 以下なら合格。
+         参照は2種類:
+           - スケッチ（1ファイル）: チャンネルごとのエネルギーとランダムな射影だけを持つ小さなテキスト。
+             リポジトリの Tools/Regression/References/GoldenSketches.txt がこれで、CTest もこれを使う
+           - WAV（フォルダ）: 32bit float の出力そのもの。誤差のピーク（--peak-db、dBFS）も見られる
+      2. ブロック分割: 同じ入力を固定長・1サンプルずつ・素数長・ランダムな長さのブロックに分けて通し、
+         出力がビット単位で一致すること（パラメータは途中で変えない）
+      3. 処理時間: 同じマシンで --record-budgets した ns/sample から --budget-margin 以上遅くならないこと。
+         マシンに依存するので、基準を取ったときだけ使う（CTest では任意）
+    出力を比べるレンダリングはすべて setNonRealtime(true) で行う
+    （畳み込みのワーカーの間に合い方で結果が変わらないように）。
+    参照はレンダリングの設定（基準のブロックサイズ・信号の長さ・射影の数）と一緒に書き出し、
+    設定が違う参照とは比べない。
+
+    使い方:
+      DomeReverbRegression --record-sketches 参照ファイル
+      DomeReverbRegression --record 参照フォルダ
+      DomeReverbRegression --check 参照ファイルかフォルダ [--tolerance-db -90] [--peak-db -80]
+      DomeReverbRegression --split
+      DomeReverbRegression --record-budgets 基準ファイル
+      DomeReverbRegression --budgets 基準ファイル [--budget-margin 0.3]
+      DomeReverbRegression --all 参照ファイルかフォルダ   （--check と --split をまとめて）
+
+    終了コード: 0 = すべて合格、1 = 不合格あり（参照が見つからない場合も含む）
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DSP/DomeReverb.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    //==========================================================================
+    // 設定
+    struct RegressionConfig
+    {
+        juce::File recordSketches;
+        juce::File recordDirectory;
+        juce::File checkReferences;       // スケッチのファイルか WAV のフォルダ
+        bool split = false;
+        juce::File recordBudgets;
+        juce::File budgetBaseline;
+        double toleranceDb = -90.0;       // 誤差のエネルギー（参照のエネルギー比）
+        double peakToleranceDb = -80.0;   // 誤差のピーク（dBFS、WAV の参照のみ）
+        double budgetMargin = 0.3;        // 基準の ns/sample から何割まで遅くなってよいか
+    };
+
+    enum class Signal { Impulse, Sweep, Noise };
+
+    const char* signalNames[] = { "impulse", "sweep", "noise" };
+    const char* presetNames[] = { "arena", "stadium", "hall", "club" };
+    const char* engineNames[] = { "classic", "fdn8", "fdn16", "convolution" };
+    const char* qualityNames[] = { "eco", "standard", "high" };
+
+    constexpr double signalSeconds = 0.5;    // 入力（スイープ・ノイズ）の長さ
+    constexpr double renderSeconds = 1.5;    // テールを含めて書き出す長さ
+    constexpr int maxBlockSize = 4096;
+    constexpr int referenceBlockSize = 512;
+    const int checkBlockSizes[] = { 64, 441, maxBlockSize };
+
+    // テスト信号と IR のノイズ。参照をどのマシン・どの JUCE で作っても同じ入力になるように、
+    // juce::Random ではなく自前の線形合同法で [-1, 1) を作る
+    struct NoiseGenerator
+    {
+        explicit NoiseGenerator(uint32_t seed) : state(seed) {}
+
+        float next()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+        }
+
+        uint32_t state;
+    };
+
+    //==========================================================================
+    // テスト信号（ステレオ、renderSeconds の長さ）
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType> makeSignal(Signal signal, double sampleRate)
+    {
+        juce::AudioBuffer<SampleType> buffer(2, static_cast<int>(sampleRate * renderSeconds));
+        buffer.clear();
+        const int length = static_cast<int>(sampleRate * signalSeconds);
+
+        switch (signal)
+        {
+            case Signal::Impulse:
+                // R は少し遅らせて、L/R が同じにならないようにする
+                buffer.setSample(0, 0, SampleType(0.5));
+                buffer.setSample(1, 37, SampleType(0.5));
+                break;
+
+            case Signal::Sweep:
+            {
+                // 20Hz からナイキストの手前までの対数スイープ（R は位相を 90 度ずらす）
+                const double startHz = 20.0;
+                const double endHz = sampleRate * 0.45;
+                const double rate = std::log(endHz / startHz);
+                for (int i = 0; i < length; ++i)
+                {
+                    const double t = i / sampleRate;
+                    const double phase = juce::MathConstants<double>::twoPi * startHz * signalSeconds / rate
+                                       * (std::exp(t / signalSeconds * rate) - 1.0);
+                    buffer.setSample(0, i, static_cast<SampleType>(0.5 * std::sin(phase)));
+                    buffer.setSample(1, i, static_cast<SampleType>(0.5 * std::cos(phase)));
+                }
+                break;
+            }
+
+            case Signal::Noise:
+            {
+                NoiseGenerator noise(12345);
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < length; ++i)
+                        buffer.setSample(ch, i, static_cast<SampleType>(noise.next() * 0.3f));
+                break;
+            }
+        }
+        return buffer;
+    }
+
+    // 減衰するノイズの IR（実測 IR の代わり）
+    std::shared_ptr<const ConvolutionIR> makeImpulseResponse(double sampleRate)
+    {
+        const double seconds = 1.0;
+        juce::AudioBuffer<float> ir(2, static_cast<int>(sampleRate * seconds));
+        NoiseGenerator noise(7);
+        for (int ch = 0; ch < ir.getNumChannels(); ++ch)
+            for (int i = 0; i < ir.getNumSamples(); ++i)
+                ir.setSample(ch, i, noise.next()
+                                        * std::exp(-6.9f * static_cast<float>(i / (sampleRate * seconds))));
+        return ConvolutionIR::create(ir, sampleRate, sampleRate);
+    }
+
+    //==========================================================================
+    // レンダリング
+    struct ReverbSettings
+    {
+        DomePreset preset = DomePreset::Arena;
+        float amount = 0.6f;
+        ReverbEngine engine = ReverbEngine::Classic;
+        ReverbQuality quality = ReverbQuality::Standard;
+    };
+
+    template <typename SampleType>
+    void prepareReverb(DomeReverb<SampleType>& reverb, const ReverbSettings& settings, double sampleRate,
+                       int blockSize, bool nonRealtime,
+                       const juce::AudioChannelSet& layout = juce::AudioChannelSet::stereo())
+    {
+        reverb.setNonRealtime(nonRealtime);
+        reverb.prepare(sampleRate, blockSize, layout);
+        if (settings.engine == ReverbEngine::Convolution)
+            reverb.setImpulseResponse(makeImpulseResponse(reverb.getInternalSampleRate()));
+        reverb.setEngine(settings.engine);
+        reverb.setQuality(settings.quality);
+        reverb.setPreset(settings.preset);
+        reverb.setDomeAmount(settings.amount);
+    }
+
+    // input を nextBlockSize() が返す長さのブロックに分けて通した出力
+    template <typename SampleType, typename BlockSizes>
+    juce::AudioBuffer<SampleType> render(const ReverbSettings& settings, double sampleRate,
+                                         const juce::AudioBuffer<SampleType>& input, BlockSizes&& nextBlockSize,
+                                         const juce::AudioChannelSet& layout = juce::AudioChannelSet::stereo())
+    {
+        DomeReverb<SampleType> reverb;
+        prepareReverb(reverb, settings, sampleRate, maxBlockSize, true, layout);
+
+        juce::AudioBuffer<SampleType> output(input);
+        const int numSamples = output.getNumSamples();
+        for (int position = 0; position < numSamples;)
+        {
+            const int n = std::min(nextBlockSize(), numSamples - position);
+            juce::AudioBuffer<SampleType> view(output.getArrayOfWritePointers(), output.getNumChannels(), position, n);
+            reverb.process(view);
+            position += n;
+        }
+        return output;
+    }
+
+    //==========================================================================
+    // 1. ゴールデン出力
+    struct GoldenCase
+    {
+        Signal signal;
+        double sampleRate;
+        ReverbSettings settings;
+
+        juce::String getName() const
+        {
+            return juce::String(signalNames[static_cast<int>(signal)])
+                 + "_" + presetNames[static_cast<int>(settings.preset)]
+                 + "_" + juce::String(juce::roundToInt(settings.amount * 100.0f))
+                 + "_" + juce::String(juce::roundToInt(sampleRate))
+                 + "_" + engineNames[static_cast<int>(settings.engine)]
+                 + "_" + qualityNames[static_cast<int>(settings.quality)];
+        }
+    };
+
+    juce::Array<GoldenCase> makeGoldenCases()
+    {
+        juce::Array<GoldenCase> cases;
+
+        // 全プリセット × domeAmount × サンプルレート（96kHz は間引いた内部レートの経路）
+        for (auto sampleRate : { 44100.0, 96000.0 })
+            for (int p = 0; p < 4; ++p)
+                for (auto amount : { 0.25f, 0.6f, 1.0f })
+                    for (int s = 0; s < 3; ++s)
+                        cases.add({ static_cast<Signal>(s), sampleRate,
+                                    { static_cast<DomePreset>(p), amount, ReverbEngine::Classic, ReverbQuality::Standard } });
+
+        // Standard 以外の品質とエンジン（Arena / 48kHz）
+        const std::pair<ReverbEngine, ReverbQuality> paths[] = {
+            { ReverbEngine::Classic, ReverbQuality::Eco },
+            { ReverbEngine::Classic, ReverbQuality::High },
+            { ReverbEngine::Fdn8, ReverbQuality::Standard },
+            { ReverbEngine::Fdn16, ReverbQuality::Standard },
+            { ReverbEngine::Convolution, ReverbQuality::Standard },
+        };
+        for (const auto& path : paths)
+            for (int s = 0; s < 3; ++s)
+                cases.add({ static_cast<Signal>(s), 48000.0,
+                            { DomePreset::Arena, 0.6f, path.first, path.second } });
+
+        return cases;
+    }
+
+    // 参照と比べるときのレンダリングの設定。参照と一緒に書き出し、違えば比べない
+    constexpr int sketchProjections = 32;
+
+    juce::String getRenderSettings()
+    {
+        return "block " + juce::String(referenceBlockSize)
+             + " signal " + juce::String(signalSeconds, 2)
+             + " render " + juce::String(renderSeconds, 2)
+             + " projections " + juce::String(sketchProjections);
+    }
+
+    juce::AudioBuffer<float> renderReference(const GoldenCase& c)
+    {
+        return render(c.settings, c.sampleRate, makeSignal<float>(c.signal, c.sampleRate),
+                      [] { return referenceBlockSize; });
+    }
+
+    // 誤差のエネルギー（参照比 dB）と誤差のピーク（dBFS）
+    struct Difference
+    {
+        double errorDb = -300.0;
+        double peakDb = -300.0;
+    };
+
+    Difference makeDifference(double errorEnergy, double referenceEnergy, double peak)
+    {
+        Difference d;
+        if (errorEnergy > 0.0)
+            d.errorDb = referenceEnergy > 0.0 ? 10.0 * std::log10(errorEnergy / referenceEnergy) : 0.0;
+        if (peak > 0.0)
+            d.peakDb = 20.0 * std::log10(peak);
+        return d;
+    }
+
+    // ブロックサイズごとに通して参照と比べ、いちばん悪いものを返す
+    template <typename Compare>
+    Difference compareBlockSizes(const GoldenCase& c, Compare&& compare)
+    {
+        const auto input = makeSignal<float>(c.signal, c.sampleRate);
+
+        Difference worst;
+        for (const int blockSize : checkBlockSizes)
+        {
+            const auto d = compare(render(c.settings, c.sampleRate, input, [=] { return blockSize; }));
+            worst.errorDb = std::max(worst.errorDb, d.errorDb);
+            worst.peakDb = std::max(worst.peakDb, d.peakDb);
+        }
+        return worst;
+    }
+
+    //==========================================================================
+    // 1a. スケッチの参照（リポジトリに入れる）
+    // 出力を丸ごと持つ代わりに、チャンネルごとのエネルギーと、サンプルごとに ±1 を掛けて足した値（射影）を
+    // sketchProjections 個だけ持つ。誤差 e = 出力 - 参照 の射影は 出力の射影 - 参照の射影 で、
+    // その二乗の期待値は Σ e[i]^2 なので、射影の差の二乗平均が誤差のエネルギーの見積もりになる
+    // （32 個で ±1 dB ほど。一致していれば 0）
+    struct ChannelSketch
+    {
+        double energy = 0.0;
+        std::array<double, sketchProjections> projections {};
+    };
+
+    struct Sketch
+    {
+        juce::String name;
+        int numSamples = 0;
+        std::vector<ChannelSketch> channels;
+    };
+
+    // サンプル i の重みの符号（ビット j が射影 j の符号）
+    uint32_t sketchSigns(uint32_t i)
+    {
+        i = i * 0x9e3779b9u + 0x7f4a7c15u;
+        i ^= i >> 16;
+        i *= 0x85ebca6bu;
+        i ^= i >> 13;
+        i *= 0xc2b2ae35u;
+        i ^= i >> 16;
+        return i;
+    }
+
+    Sketch makeSketch(const juce::String& name, const juce::AudioBuffer<float>& output)
+    {
+        Sketch sketch { name, output.getNumSamples(), {} };
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+        {
+            ChannelSketch channel;
+            const float* data = output.getReadPointer(ch);
+            for (int i = 0; i < output.getNumSamples(); ++i)
+            {
+                const double x = data[i];
+                const uint32_t signs = sketchSigns(static_cast<uint32_t>(i));
+                channel.energy += x * x;
+                for (int j = 0; j < sketchProjections; ++j)
+                    channel.projections[static_cast<size_t>(j)] += (signs >> j) & 1u ? x : -x;
+            }
+            sketch.channels.push_back(channel);
+        }
+        return sketch;
+    }
+
+    Difference compare(const Sketch& output, const Sketch& reference)
+    {
+        double errorEnergy = 0.0, referenceEnergy = 0.0;
+        for (size_t ch = 0; ch < reference.channels.size(); ++ch)
+        {
+            double sum = 0.0;
+            for (int j = 0; j < sketchProjections; ++j)
+            {
+                const double error = output.channels[ch].projections[static_cast<size_t>(j)]
+                                   - reference.channels[ch].projections[static_cast<size_t>(j)];
+                sum += error * error;
+            }
+            errorEnergy += sum / sketchProjections;
+            referenceEnergy += reference.channels[ch].energy;
+        }
+        return makeDifference(errorEnergy, referenceEnergy, 0.0);
+    }
+
+    // 形式（1行ずつ、# から後はコメント）:
+    //   settings <getRenderSettings()>
+    //   case <名前> <チャンネル数> <サンプル数>
+    //   <エネルギー> <射影 0> ... <射影 31>     （チャンネルの数だけ）
+    bool recordSketches(const juce::File& file)
+    {
+        juce::String text;
+        text << "# DomeReverb golden output sketches (DomeReverbRegression --record-sketches)\n"
+             << "settings " << getRenderSettings() << "\n";
+
+        int written = 0;
+        for (const auto& c : makeGoldenCases())
+        {
+            const auto sketch = makeSketch(c.getName(), renderReference(c));
+            text << "case " << sketch.name << " " << static_cast<int>(sketch.channels.size())
+                 << " " << sketch.numSamples << "\n";
+            for (const auto& channel : sketch.channels)
+            {
+                text << juce::String(channel.energy, 9, true);
+                for (const auto projection : channel.projections)
+                    text << " " << juce::String(projection, 9, true);
+                text << "\n";
+            }
+            ++written;
+        }
+
+        if (! file.replaceWithText(text, false, false, "\n"))
+        {
+            std::cout << "cannot write " << file.getFullPathName() << "\n";
+            return false;
+        }
+        std::cout << written << " reference sketches written to " << file.getFullPathName() << "\n";
+        return true;
+    }
+
+    bool readSketches(const juce::File& file, std::vector<Sketch>& sketches)
+    {
+        juce::StringArray lines;
+        file.readLines(lines);
+
+        bool settingsMatch = false;
+        for (int l = 0; l < lines.size(); ++l)
+        {
+            const auto line = lines[l].upToFirstOccurrenceOf("#", false, false).trim();
+            if (line.isEmpty())
+                continue;
+
+            if (line.startsWith("settings "))
+            {
+                settingsMatch = line.fromFirstOccurrenceOf("settings ", false, false) == getRenderSettings();
+                continue;
+            }
+
+            const auto tokens = juce::StringArray::fromTokens(line, false);
+            if (tokens.size() != 4 || tokens[0] != "case")
+            {
+                std::cout << "  malformed line " << l + 1 << " in " << file.getFullPathName() << "\n";
+                return false;
+            }
+
+            Sketch sketch { tokens[1], tokens[3].getIntValue(), {} };
+            const int numChannels = tokens[2].getIntValue();
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto values = juce::StringArray::fromTokens(++l < lines.size() ? lines[l] : juce::String(), false);
+                if (values.size() != 1 + sketchProjections)
+                {
+                    std::cout << "  malformed line " << l + 1 << " in " << file.getFullPathName() << "\n";
+                    return false;
+                }
+
+                ChannelSketch channel;
+                channel.energy = values[0].getDoubleValue();
+                for (int j = 0; j < sketchProjections; ++j)
+                    channel.projections[static_cast<size_t>(j)] = values[1 + j].getDoubleValue();
+                sketch.channels.push_back(channel);
+            }
+            sketches.push_back(sketch);
+        }
+
+        if (! settingsMatch)
+            std::cout << "  references were recorded with different render settings (expected \""
+                      << getRenderSettings() << "\")\n";
+        return settingsMatch;
+    }
+
+    bool checkSketches(const RegressionConfig& config)
+    {
+        std::vector<Sketch> references;
+        if (! readSketches(config.checkReferences, references))
+            return false;
+
+        int failures = 0, numCases = 0;
+        for (const auto& c : makeGoldenCases())
+        {
+            ++numCases;
+            const auto name = c.getName();
+            const auto reference = std::find_if(references.begin(), references.end(),
+                                                [&](const Sketch& s) { return s.name == name; });
+            if (reference == references.end())
+            {
+                std::cout << "  FAIL " << name << ": no reference\n";
+                ++failures;
+                continue;
+            }
+
+            const auto input = makeSignal<float>(c.signal, c.sampleRate);
+            if (static_cast<int>(reference->channels.size()) != input.getNumChannels()
+                || reference->numSamples != input.getNumSamples())
+            {
+                std::cout << "  FAIL " << name << ": reference has a different length or channel count\n";
+                ++failures;
+                continue;
+            }
+
+            const auto worst = compareBlockSizes(c, [&](const juce::AudioBuffer<float>& output)
+            {
+                return compare(makeSketch(name, output), *reference);
+            });
+
+            if (worst.errorDb > config.toleranceDb)
+            {
+                std::cout << "  FAIL " << name << ": error " << juce::String(worst.errorDb, 1) << " dB\n";
+                ++failures;
+            }
+        }
+
+        std::cout << "  " << numCases - failures << " / " << numCases << " passed\n";
+        return failures == 0;
+    }
+
+    //==========================================================================
+    // 1b. WAV の参照（手元で、サンプル単位で比べたいとき）
+    bool recordReferences(const juce::File& directory)
+    {
+        if (! directory.createDirectory())
+        {
+            std::cout << "cannot create " << directory.getFullPathName() << "\n";
+            return false;
+        }
+
+        // 設定はフォルダの中のテキストに残す
+        if (! directory.getChildFile("settings.txt").replaceWithText(getRenderSettings() + "\n", false, false, "\n"))
+        {
+            std::cout << "cannot write " << directory.getChildFile("settings.txt").getFullPathName() << "\n";
+            return false;
+        }
+
+        juce::WavAudioFormat wavFormat;
+        int written = 0;
+        for (const auto& c : makeGoldenCases())
+        {
+            const auto output = renderReference(c);
+
+            // FileOutputStream は既存のファイルに追記するので、先に消しておく
+            const auto file = directory.getChildFile(c.getName() + ".wav");
+            file.deleteFile();
+            std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+            std::unique_ptr<juce::AudioFormatWriter> writer(
+                stream != nullptr ? wavFormat.createWriterFor(stream.get(), c.sampleRate,
+                                                              static_cast<unsigned int>(output.getNumChannels()), 32, {}, 0)
+                                  : nullptr);
+            if (writer == nullptr)
+            {
+                std::cout << "cannot write " << file.getFullPathName() << "\n";
+                return false;
+            }
+            stream.release();   // writer が持つ
+            writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+            ++written;
+        }
+
+        std::cout << written << " references written to " << directory.getFullPathName() << "\n";
+        return true;
+    }
+
+    Difference compare(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference)
+    {
+        double errorEnergy = 0.0, referenceEnergy = 0.0, peak = 0.0;
+        for (int ch = 0; ch < reference.getNumChannels(); ++ch)
+        {
+            const float* out = output.getReadPointer(ch);
+            const float* ref = reference.getReadPointer(ch);
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                const double error = static_cast<double>(out[i]) - ref[i];
+                errorEnergy += error * error;
+                referenceEnergy += static_cast<double>(ref[i]) * ref[i];
+                peak = std::max(peak, std::abs(error));
+            }
+        }
+        return makeDifference(errorEnergy, referenceEnergy, peak);
+    }
+
+    bool checkReferences(const RegressionConfig& config)
+    {
+        const auto settings = config.checkReferences.getChildFile("settings.txt").loadFileAsString().trim();
+        if (settings != getRenderSettings())
+        {
+            std::cout << "  references were recorded with different render settings (expected \""
+                      << getRenderSettings() << "\")\n";
+            return false;
+        }
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        int failures = 0, numCases = 0;
+        for (const auto& c : makeGoldenCases())
+        {
+            ++numCases;
+            const auto name = c.getName();
+            std::unique_ptr<juce::AudioFormatReader> reader(
+                formatManager.createReaderFor(config.checkReferences.getChildFile(name + ".wav")));
+            if (reader == nullptr)
+            {
+                std::cout << "  FAIL " << name << ": no reference\n";
+                ++failures;
+                continue;
+            }
+
+            juce::AudioBuffer<float> reference(static_cast<int>(reader->numChannels),
+                                               static_cast<int>(reader->lengthInSamples));
+            reader->read(&reference, 0, reference.getNumSamples(), 0, true, true);
+
+            const auto input = makeSignal<float>(c.signal, c.sampleRate);
+            if (reference.getNumChannels() != input.getNumChannels() || reference.getNumSamples() != input.getNumSamples())
+            {
+                std::cout << "  FAIL " << name << ": reference has a different length or channel count\n";
+                ++failures;
+                continue;
+            }
+
+            const auto worst = compareBlockSizes(c, [&](const juce::AudioBuffer<float>& output)
+            {
+                return compare(output, reference);
+            });
+
+            if (worst.errorDb > config.toleranceDb || worst.peakDb > config.peakToleranceDb)
+            {
+                std::cout << "  FAIL " << name << ": error " << juce::String(worst.errorDb, 1)
+                          << " dB, peak " << juce::String(worst.peakDb, 1) << " dBFS\n";
+                ++failures;
+            }
+        }
+
+        std::cout << "  " << numCases - failures << " / " << numCases << " passed\n";
+        return failures == 0;
+    }
+
+    bool checkGolden(const RegressionConfig& config)
+    {
+        std::cout << "golden output (" << config.checkReferences.getFullPathName() << ")\n";
+
+        if (config.checkReferences.isDirectory())
+            return checkReferences(config);
+        if (config.checkReferences.existsAsFile())
+            return checkSketches(config);
+
+        std::cout << "  FAIL no references at " << config.checkReferences.getFullPathName() << "\n";
+        return false;
+    }
+
+    //==========================================================================
+    // 2. ブロック分割（同じ入力をどう分けても出力がビット単位で一致すること）
+    struct SplitCase
+    {
+        const char* name;
+        double sampleRate;
+        ReverbSettings settings;
+        juce::AudioChannelSet layout = juce::AudioChannelSet::stereo();
+    };
+
+    // 多チャンネルの配置では入力のステレオを先頭の2チャンネルに入れ、残りはずらしたコピー
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType> makeSplitInput(double sampleRate, int numChannels)
+    {
+        const auto noise = makeSignal<SampleType>(Signal::Noise, sampleRate);
+        juce::AudioBuffer<SampleType> input(numChannels, noise.getNumSamples());
+        input.clear();
+        for (int ch = 0; ch < numChannels; ++ch)
+            input.copyFrom(ch, ch / 2 * 11, noise, ch % 2, 0, noise.getNumSamples() - ch / 2 * 11);
+        return input;
+    }
+
+    template <typename SampleType>
+    bool checkSplit(const SplitCase& c)
+    {
+        const auto input = makeSplitInput<SampleType>(c.sampleRate, c.layout.size());
+        const auto expected = render(c.settings, c.sampleRate, input, [] { return referenceBlockSize; }, c.layout);
+
+        juce::Random random(99);
+        const std::pair<const char*, std::function<int()>> splits[] = {
+            { "single samples", [] { return 1; } },
+            { "prime blocks", [] { return 37; } },
+            { "max blocks", [] { return maxBlockSize; } },
+            { "random blocks", [&random] { return 1 + random.nextInt(maxBlockSize); } },
+        };
+
+        bool ok = true;
+        for (const auto& split : splits)
+        {
+            const auto output = render(c.settings, c.sampleRate, input, split.second, c.layout);
+
+            for (int ch = 0; ch < input.getNumChannels(); ++ch)
+            {
+                const SampleType* out = output.getReadPointer(ch);
+                const SampleType* ref = expected.getReadPointer(ch);
+                const int mismatch = static_cast<int>(std::mismatch(out, out + input.getNumSamples(), ref).first - out);
+                if (mismatch < input.getNumSamples())
+                {
+                    std::cout << "  FAIL " << c.name << " (" << split.first << "): channel " << ch
+                              << " differs from sample " << mismatch << "\n";
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        return ok;
+    }
+
+    bool checkBlockSplits()
+    {
+        std::cout << "block split invariance\n";
+
+        const SplitCase cases[] = {
+            { "classic standard 44.1k", 44100.0, {} },
+            { "classic eco 48k", 48000.0, { DomePreset::Stadium, 0.8f, ReverbEngine::Classic, ReverbQuality::Eco } },
+            { "classic high 48k", 48000.0, { DomePreset::Hall, 0.4f, ReverbEngine::Classic, ReverbQuality::High } },
+            { "fdn8 48k", 48000.0, { DomePreset::Club, 0.25f, ReverbEngine::Fdn8, ReverbQuality::Standard } },
+            { "fdn16 96k", 96000.0, { DomePreset::Arena, 1.0f, ReverbEngine::Fdn16, ReverbQuality::Standard } },
+            { "convolution 48k", 48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Convolution, ReverbQuality::Standard } },
+            { "classic standard 192k", 192000.0, {} },
+            { "classic standard 5.1", 48000.0, {}, juce::AudioChannelSet::create5point1() },
+        };
+
+        int failures = 0;
+        for (const auto& c : cases)
+            if (! checkSplit<float>(c))
+                ++failures;
+
+        // 倍精度の経路
+        if (! checkSplit<double>({ "classic standard 96k double", 96000.0, {} }))
+            ++failures;
+
+        std::cout << "  " << (failures == 0 ? "passed" : juce::String(failures) + " configurations failed") << "\n";
+        return failures == 0;
+    }
+
+    //==========================================================================
+    // 3. 処理時間（48kHz / 96kHz、ブロック 256、ステレオ、ns/sample）
+    // 上限はマシンで大きく変わるので固定値は持たない。同じマシンで --record-budgets した基準と比べ、
+    // --budget-margin より遅くなった構成を不合格にする
+    struct Budget
+    {
+        const char* name;
+        double sampleRate;
+        ReverbSettings settings;
+    };
+
+    const Budget budgets[] = {
+        { "classic-eco-48k",      48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Classic, ReverbQuality::Eco } },
+        { "classic-standard-48k", 48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Classic, ReverbQuality::Standard } },
+        { "classic-high-48k",     48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Classic, ReverbQuality::High } },
+        { "fdn8-48k",             48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Fdn8, ReverbQuality::Standard } },
+        { "fdn16-48k",            48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Fdn16, ReverbQuality::Standard } },
+        { "convolution-48k",      48000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Convolution, ReverbQuality::Standard } },
+        { "classic-standard-96k", 96000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Classic, ReverbQuality::Standard } },
+        { "fdn16-96k",            96000.0, { DomePreset::Arena, 0.6f, ReverbEngine::Fdn16, ReverbQuality::Standard } },
+    };
+
+    constexpr int budgetBlockSize = 256;
+    constexpr int budgetRepeats = 5;
+
+    // ns/sample（ベンチマークと同じく、ウォームアップのあと数回測っていちばん速いもの）
+    double measure(const Budget& budget)
+    {
+        // プラグインと同じくリアルタイムの設定で（畳み込みのテールはワーカーが受け持つ）
+        DomeReverb<float> reverb;
+        prepareReverb(reverb, budget.settings, budget.sampleRate, budgetBlockSize, false);
+
+        const auto input = makeSignal<float>(Signal::Noise, budget.sampleRate);
+        const int numBlocks = static_cast<int>(budget.sampleRate * signalSeconds) / budgetBlockSize;
+        juce::AudioBuffer<float> block(2, budgetBlockSize);
+
+        auto processBlocks = [&](int count)
+        {
+            for (int b = 0; b < count; ++b)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    block.copyFrom(ch, 0, input, ch, b % numBlocks * budgetBlockSize, budgetBlockSize);
+                reverb.process(block);
+            }
+        };
+
+        processBlocks(64);
+
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < budgetRepeats; ++r)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            processBlocks(numBlocks * 4);
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            const double seconds = juce::Time::highResolutionTicksToSeconds(end - start);
+            best = std::min(best, seconds * 1.0e9 / (static_cast<double>(numBlocks) * 4 * budgetBlockSize));
+        }
+        return best;
+    }
+
+    // 形式: 1行に「<構成の名前> <ns/sample>」
+    bool recordBudgets(const juce::File& file)
+    {
+        juce::String text;
+        text << "# DomeReverb ns/sample baseline (block " << budgetBlockSize << ")\n";
+        for (const auto& budget : budgets)
+        {
+            const double ns = measure(budget);
+            text << budget.name << " " << juce::String(ns, 2) << "\n";
+            std::cout << "  " << juce::String(budget.name).paddedRight(' ', 24)
+                      << juce::String(ns, 1).paddedLeft(' ', 8) << " ns\n";
+        }
+
+        if (! file.replaceWithText(text, false, false, "\n"))
+        {
+            std::cout << "cannot write " << file.getFullPathName() << "\n";
+            return false;
+        }
+        std::cout << "baseline written to " << file.getFullPathName() << "\n";
+        return true;
+    }
+
+    bool checkBudgets(const RegressionConfig& config)
+    {
+        std::cout << "ns/sample against " << config.budgetBaseline.getFullPathName()
+                  << " (block " << budgetBlockSize << ", margin " << juce::String(config.budgetMargin * 100.0, 0) << "%)\n";
+
+        juce::StringArray lines;
+        config.budgetBaseline.readLines(lines);
+
+        int failures = 0;
+        for (const auto& budget : budgets)
+        {
+            double baseline = 0.0;
+            for (const auto& line : lines)
+            {
+                const auto tokens = juce::StringArray::fromTokens(line.upToFirstOccurrenceOf("#", false, false), false);
+                if (tokens.size() == 2 && tokens[0] == budget.name)
+                    baseline = tokens[1].getDoubleValue();
+            }
+
+            if (baseline <= 0.0)
+            {
+                std::cout << "  FAIL " << budget.name << ": no baseline\n";
+                ++failures;
+                continue;
+            }
+
+            const double ns = measure(budget);
+            const double limit = baseline * (1.0 + config.budgetMargin);
+            const bool ok = ns <= limit;
+            if (! ok)
+                ++failures;
+
+            std::cout << "  " << (ok ? "ok   " : "FAIL ") << juce::String(budget.name).paddedRight(' ', 24)
+                      << juce::String(ns, 1).paddedLeft(' ', 8) << " / " << juce::String(limit, 1) << " ns\n";
+        }
+        return failures == 0;
+    }
+
+    //==========================================================================
+    bool parseArguments(const juce::StringArray& args, RegressionConfig& config)
+    {
+        const auto path = [](const juce::String& name)
+        {
+            return juce::File::getCurrentWorkingDirectory().getChildFile(name);
+        };
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--record-sketches" && hasValue)
+                config.recordSketches = path(args[++i]);
+            else if (arg == "--record" && hasValue)
+                config.recordDirectory = path(args[++i]);
+            else if (arg == "--check" && hasValue)
+                config.checkReferences = path(args[++i]);
+            else if (arg == "--all" && hasValue)
+            {
+                config.checkReferences = path(args[++i]);
+                config.split = true;
+            }
+            else if (arg == "--split")
+                config.split = true;
+            else if (arg == "--record-budgets" && hasValue)
+                config.recordBudgets = path(args[++i]);
+            else if (arg == "--budgets" && hasValue)
+                config.budgetBaseline = path(args[++i]);
+            else if (arg == "--tolerance-db" && hasValue)
+                config.toleranceDb = args[++i].getDoubleValue();
+            else if (arg == "--peak-db" && hasValue)
+                config.peakToleranceDb = args[++i].getDoubleValue();
+            else if (arg == "--budget-margin" && hasValue)
+                config.budgetMargin = args[++i].getDoubleValue();
+            else
+                return false;
+        }
+
+        // 参照・基準の書き出しは1つずつ、他のチェックと混ぜない
+        const int numRecords = (config.recordSketches != juce::File() ? 1 : 0)
+                             + (config.recordDirectory != juce::File() ? 1 : 0)
+                             + (config.recordBudgets != juce::File() ? 1 : 0);
+        const bool anyCheck = config.checkReferences != juce::File() || config.split
+                           || config.budgetBaseline != juce::File();
+        if (numRecords > 0)
+            return numRecords == 1 && ! anyCheck;
+
+        return anyCheck && config.budgetMargin >= 0.0;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    RegressionConfig config;
+    if (! parseArguments(args, config))
+    {
+        std::cerr << "Usage: DomeReverbRegression --record-sketches file | --record dir | --record-budgets file\n"
+                     "       DomeReverbRegression [--check file|dir] [--split] [--budgets file] [--all file|dir]\n"
+                     "                            [--tolerance-db dB] [--peak-db dBFS] [--budget-margin x]\n";
+        return 1;
+    }
+
+    if (config.recordSketches != juce::File())
+        return recordSketches(config.recordSketches) ? 0 : 1;
+    if (config.recordDirectory != juce::File())
+        return recordReferences(config.recordDirectory) ? 0 : 1;
+    if (config.recordBudgets != juce::File())
+        return recordBudgets(config.recordBudgets) ? 0 : 1;
+
+    bool ok = true;
+    if (config.checkReferences != juce::File())
+        ok = checkGolden(config) && ok;
+    if (config.split)
+        ok = checkBlockSplits() && ok;
+    if (config.budgetBaseline != juce::File())
+        ok = checkBudgets(config) && ok;
+
+    std::cout << (ok ? "PASSED" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}